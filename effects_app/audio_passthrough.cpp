@@ -1,4 +1,5 @@
 #include "audio_passthrough.h"
+#include <algorithm>
 
 AudioPassthrough::AudioPassthrough(AudioEffect *effect)
     : audio_(RtAudio::WINDOWS_ASIO), effect_(effect)
@@ -21,6 +22,7 @@ void AudioPassthrough::start(unsigned int sampleRate, unsigned int bufferFrames)
     {
         audio_.openStream(&outputParams_, &inputParams_, RTAUDIO_FLOAT32,
                           sampleRate, &bufferFrames, &AudioPassthrough::callback, this);
+        block_.assign(bufferFrames, 0.0f);
 
         audio_.startStream();
         while (running)
@@ -53,12 +55,27 @@ int AudioPassthrough::callback(void *outputBuffer, void *inputBuffer,
     float *in = static_cast<float *>(inputBuffer);
     float *out = static_cast<float *>(outputBuffer);
 
-    for (unsigned int i = 0; i < nFrames; ++i)
+    // The effect runs once per block (in chunks if the device delivers more than it asked for),
+    // then the mono result is duplicated onto both output channels
+    float *block = self->block_.data();
+    unsigned int capacity = static_cast<unsigned int>(self->block_.size());
+    for (unsigned int done = 0; done < nFrames;)
     {
-        float inputSample = in ? in[i] : 0.0f;
-        float processed = self->effect_ ? self->effect_->process(inputSample) : inputSample;
-        out[2 * i] = processed;
-        out[2 * i + 1] = processed;
+        unsigned int count = std::min(nFrames - done, capacity);
+        const float *source = in ? in + done : block;
+        if (!in)
+            std::fill(block, block + count, 0.0f);
+        if (self->effect_)
+            self->effect_->processBlock(source, block, count);
+        else if (source != block)
+            std::copy(source, source + count, block);
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            out[2 * (done + i)] = block[i];
+            out[2 * (done + i) + 1] = block[i];
+        }
+        done += count;
     }
 
     return 0;
@@ -6,6 +6,7 @@
 #include <atomic>
 #include "RtAudio.h"
 #include "effects.h"
+#include <vector>
 
 extern std::atomic<bool> running;
 
@@ -25,5 +26,6 @@ private:
     RtAudio audio_;
     RtAudio::StreamParameters inputParams_, outputParams_;
     AudioEffect* effect_;
+    std::vector<float> block_; // mono scratch for one callback, sized in start()
 };
 
@@ -0,0 +1,131 @@
+// Checks DelayLine against the signal it was fed. The fractional taps (linear, Lagrange and
+// AllpassTap) read a sine at delays across the line and are compared with the sine evaluated at that
+// delay; block write()/read() and writeRuns() (delays shorter than a run included) must match the
+// per-sample write()/tap() path exactly, through every wrap of a small line. Prints the worst error of
+// each and exits non-zero if one is over its limit.
+// Build from effects_app/:
+//   g++ -O2 -std=c++17 -I. bench/delay_line_check.cpp -o delay_line_check
+#include "delay_line.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000.0
+#define TONE_HZ 440.0
+#define MAX_DELAY 960             // 20 ms, the chorus line
+#define SAMPLES 48000
+#define WARMUP 64                 // samples before the allpass state has settled
+#define LINEAR_LIMIT 1e-3
+#define LAGRANGE_LIMIT 1e-4
+#define ALLPASS_LIMIT 1e-4
+#define BLOCK_LINE 61             // capacity 64: block copies wrap every few calls
+#define BLOCK_ROUNDS 20000
+
+static const double PI = 3.14159265358979323846;
+
+static float tone(long n)
+{
+    return static_cast<float>(std::sin(2.0 * PI * TONE_HZ * n / SAMPLE_RATE));
+}
+
+static double expected(long newest, double delay)
+{
+    return std::sin(2.0 * PI * TONE_HZ * (newest - delay) / SAMPLE_RATE);
+}
+
+static bool report(const char* name, double error, double limit)
+{
+    bool ok = error <= limit;
+    std::printf("%-22s max error %.2e (limit %.0e) %s\n", name, error, limit, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool reportMismatches(const char* name, long mismatches)
+{
+    std::printf("%-22s %ld samples differ %s\n", name, mismatches, mismatches == 0 ? "ok" : "FAILED");
+    return mismatches == 0;
+}
+
+int main()
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> delays(1.0f, MAX_DELAY - 3.0f);
+
+    // Modulated taps: a new random delay every sample, as the chorus reads
+    DelayLine line(MAX_DELAY);
+    double linearError = 0.0, lagrangeError = 0.0;
+    for (long n = 0; n < SAMPLES; ++n)
+    {
+        line.write(tone(n));
+        if (n < MAX_DELAY)
+            continue;
+        float delay = delays(rng);
+        linearError = std::max(linearError, std::fabs(line.linear(delay) - expected(n, delay)));
+        lagrangeError = std::max(lagrangeError, std::fabs(line.lagrange(delay) - expected(n, delay)));
+    }
+
+    // AllpassTap carries state, so each fixed delay gets its own run
+    double allpassError = 0.0;
+    for (int trial = 0; trial < 16; ++trial)
+    {
+        float delay = delays(rng);
+        DelayLine fixed(MAX_DELAY);
+        AllpassTap tap;
+        for (long n = 0; n < SAMPLES / 8; ++n)
+        {
+            fixed.write(tone(n));
+            float y = tap.read(fixed, delay);
+            if (n >= MAX_DELAY + WARMUP)
+                allpassError = std::max(allpassError, std::fabs(y - expected(n, delay)));
+        }
+    }
+
+    // Block I/O against the per-sample path
+    std::uniform_int_distribution<int> sizes(1, 40), blockDelays(0, BLOCK_LINE - 40);
+    std::uniform_int_distribution<int> feedbackDelays(1, BLOCK_LINE);
+    std::uniform_real_distribution<float> samples(-1.0f, 1.0f);
+    DelayLine blocks(BLOCK_LINE), reference(BLOCK_LINE);
+    std::vector<float> in(40), out(40);
+    long readMismatches = 0, lineMismatches = 0;
+    for (int round = 0; round < BLOCK_ROUNDS; ++round)
+    {
+        size_t n = sizes(rng);
+        for (size_t i = 0; i < n; ++i)
+            in[i] = samples(rng);
+
+        if (round % 2 == 0)
+        {
+            blocks.write(in.data(), n);
+            for (size_t i = 0; i < n; ++i)
+                reference.write(in[i]);
+            size_t delay = blockDelays(rng);
+            blocks.read(out.data(), delay, n);
+            for (size_t i = 0; i < n; ++i)
+                readMismatches += out[i] != reference.tap(delay + n - 1 - i);
+        }
+        else
+        {
+            // Feedback: every new sample adds half of the one written delay samples before it
+            size_t delay = feedbackDelays(rng), done = 0;
+            blocks.writeRuns(delay, n, [&in, &done](const float* taps, float* slots, size_t run)
+            {
+                for (size_t j = 0; j < run; ++j)
+                    slots[j] = in[done + j] + 0.5f * taps[j];
+                done += run;
+            });
+            for (size_t i = 0; i < n; ++i)
+                reference.write(in[i] + 0.5f * reference.tap(delay - 1));
+        }
+        for (size_t d = 0; d < blocks.getMaxDelay(); ++d)
+            lineMismatches += blocks.tap(d) != reference.tap(d);
+    }
+
+    bool ok = report("linear", linearError, LINEAR_LIMIT);
+    ok &= report("lagrange", lagrangeError, LAGRANGE_LIMIT);
+    ok &= report("allpass (fixed delay)", allpassError, ALLPASS_LIMIT);
+    ok &= reportMismatches("block read", readMismatches);
+    ok &= reportMismatches("write/writeRuns", lineMismatches);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Per-sample process() against processBlock() for each effect, for the full EffectChain and for the
+// same pedalboard as a StaticChain, in ns per sample, plus the largest difference between the two
+// outputs. Every variant runs on a fresh effect over the same guitar-like test signal, in blocks of
+// the given size.
+// Build from effects_app/:
+//   g++ -O2 -std=c++17 -I. bench/effects_bench.cpp effects.cpp effect_chain.cpp -o effects_bench
+#include "effect_chain.h"
+#include "effects.h"
+#include "static_chain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define SECONDS 20
+#define REPEATS 3
+
+using Pedalboard = StaticChain<DistortionEffect, ChorusEffect, DelayEffect>;
+using Factory = std::function<std::shared_ptr<AudioEffect>()>;
+
+static std::vector<float> testSignal()
+{
+    std::vector<float> signal(SAMPLE_RATE * SECONDS);
+    for (size_t i = 0; i < signal.size(); ++i)
+    {
+        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float decay = std::exp(-3.0f * std::fmod(t, 1.0f));
+        signal[i] = 0.3f * decay * (std::sin(2.0f * 3.141592f * 110.0f * t) + 0.5f * std::sin(2.0f * 3.141592f * 220.0f * t));
+    }
+    return signal;
+}
+
+// Best of REPEATS runs over the whole signal, in ns per sample
+static double run(const Factory &make, const std::vector<float> &signal, std::vector<float> &out, size_t block, bool perSample)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; ++r)
+    {
+        std::shared_ptr<AudioEffect> effect = make();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t at = 0; at < signal.size(); at += block)
+        {
+            size_t n = std::min(block, signal.size() - at);
+            if (perSample)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    out[at + i] = effect->process(signal[at + i]);
+            }
+            else
+            {
+                effect->processBlock(signal.data() + at, out.data() + at, n);
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / signal.size());
+    }
+    return best;
+}
+
+int main()
+{
+    struct Case
+    {
+        const char *name;
+        Factory make;
+    };
+    const Case cases[] = {
+        {"distortion", []
+         { return std::make_shared<DistortionEffect>(8.0f, 0.7f); }},
+        {"chorus", []
+         { return std::make_shared<ChorusEffect>(SAMPLE_RATE); }},
+        {"delay", []
+         { return std::make_shared<DelayEffect>(SAMPLE_RATE); }},
+        {"chain (3 on)", []
+         {
+             auto chain = std::make_shared<EffectChain>(3.0f);
+             chain->addEffect(std::make_shared<DistortionEffect>(8.0f, 0.7f), "Distortion");
+             chain->addEffect(std::make_shared<ChorusEffect>(SAMPLE_RATE), "Chorus");
+             chain->addEffect(std::make_shared<DelayEffect>(SAMPLE_RATE), "Delay");
+             return chain;
+         }},
+        {"chain (3 off)", []
+         {
+             auto chain = std::make_shared<EffectChain>(3.0f);
+             chain->addEffect(std::make_shared<DistortionEffect>(8.0f, 0.7f), "Distortion", false);
+             chain->addEffect(std::make_shared<ChorusEffect>(SAMPLE_RATE), "Chorus", false);
+             chain->addEffect(std::make_shared<DelayEffect>(SAMPLE_RATE), "Delay", false);
+             return chain;
+         }},
+        {"static (3 on)", []
+         {
+             return std::make_shared<Pedalboard>(3.0f, std::make_tuple(8.0f, 0.7f), std::make_tuple(SAMPLE_RATE),
+                                                 std::make_tuple(SAMPLE_RATE));
+         }},
+        {"static (3 off)", []
+         {
+             auto board = std::make_shared<Pedalboard>(3.0f, std::make_tuple(8.0f, 0.7f), std::make_tuple(SAMPLE_RATE),
+                                                       std::make_tuple(SAMPLE_RATE));
+             for (size_t i = 0; i < Pedalboard::SIZE; ++i)
+                 board->enableEffect(i, false);
+             return board;
+         }},
+    };
+    const size_t blocks[] = {64, 256};
+
+    std::vector<float> signal = testSignal();
+    std::vector<float> perSample(signal.size()), blockwise(signal.size());
+
+    std::printf("%-14s %6s %12s %12s %8s %10s\n", "effect", "block", "sample ns", "block ns", "speedup", "max diff");
+    for (const Case &c : cases)
+    {
+        for (size_t block : blocks)
+        {
+            double sampleNs = run(c.make, signal, perSample, block, true);
+            double blockNs = run(c.make, signal, blockwise, block, false);
+            float diff = 0.0f;
+            for (size_t i = 0; i < signal.size(); ++i)
+                diff = std::max(diff, std::fabs(perSample[i] - blockwise[i]));
+            std::printf("%-14s %6zu %12.2f %12.2f %7.1fx %10.2g\n", c.name, block, sampleNs, blockNs, sampleNs / blockNs, diff);
+        }
+    }
+    return 0;
+}
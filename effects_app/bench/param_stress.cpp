@@ -0,0 +1,106 @@
+// Changes every parameter and toggles every effect from two control threads as fast as they can,
+// while a third reorders the chain and inserts and removes an extra effect, and an audio thread runs
+// the chain, alternating processBlock() and process(). The output must stay finite and bounded
+// throughout; under ThreadSanitizer (or AddressSanitizer, for the snapshot reclamation) the run
+// must also report no errors.
+// Build from effects_app/:
+//   g++ -O1 -g -std=c++17 -fsanitize=thread -I. bench/param_stress.cpp effects.cpp effect_chain.cpp -o param_stress
+#include "effect_chain.h"
+#include "effects.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define BLOCK 256
+#define SECONDS 3
+// Largest plausible output: gain 10 into a clipped distortion, chorus, and the delay's feedback loop
+#define OUTPUT_LIMIT 100.0f
+
+int main()
+{
+    auto chain = std::make_shared<EffectChain>(3.0f);
+    auto distortion = std::make_shared<DistortionEffect>(8.0f, 0.7f);
+    auto chorus = std::make_shared<ChorusEffect>(SAMPLE_RATE);
+    auto delay = std::make_shared<DelayEffect>(SAMPLE_RATE);
+    chain->addEffect(distortion, "Distortion");
+    chain->addEffect(chorus, "Chorus");
+    chain->addEffect(delay, "Delay");
+
+    std::atomic<bool> running{true};
+    std::atomic<long> changes{0};
+    auto control = [&](unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        while (running.load(std::memory_order_relaxed))
+        {
+            chain->setInputGain(10.0f * unit(random));
+            distortion->setGain(20.0f * unit(random));
+            distortion->setMix(unit(random));
+            chorus->setRate(5.0f * unit(random));
+            chorus->setDepth(unit(random));
+            delay->setDelayTime(1.5f * unit(random)); // past MAX_DELAY_TIME on purpose
+            chain->toggleEffect(chain->findEffect(random() % 2 ? "Chorus" : "Delay"));
+            changes.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    };
+    std::atomic<long> reconfigurations{0};
+    auto reconfigure = [&]()
+    {
+        std::mt19937 random(3);
+        while (running.load(std::memory_order_relaxed))
+        {
+            size_t count = chain->getEffectCount();
+            chain->moveEffect(random() % count, random() % count);
+            int extra = chain->findEffect("Extra");
+            if (extra < 0)
+                chain->insertEffect(random() % (count + 1), std::make_shared<DelayEffect>(SAMPLE_RATE, 0.05f, 0.3f), "Extra");
+            else
+                chain->removeEffect(extra);
+            reconfigurations.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    };
+    std::thread first(control, 1), second(control, 2), third(reconfigure);
+
+    std::vector<float> in(BLOCK), out(BLOCK);
+    long blocks = 0, bad = 0;
+    float peak = 0.0f;
+    double t = 0.0;
+    const long total = static_cast<long>(SAMPLE_RATE) * SECONDS / BLOCK;
+    for (; blocks < total; ++blocks)
+    {
+        for (float &x : in)
+        {
+            x = 0.5f * std::sin(2.0f * 3.141592f * 110.0f * static_cast<float>(t));
+            t += 1.0 / SAMPLE_RATE;
+        }
+        if (blocks % 2 == 0)
+            chain->processBlock(in.data(), out.data(), BLOCK);
+        else
+            for (int i = 0; i < BLOCK; ++i)
+                out[i] = chain->process(in[i]);
+        for (float y : out)
+        {
+            if (!std::isfinite(y) || std::fabs(y) > OUTPUT_LIMIT)
+                ++bad;
+            else
+                peak = std::max(peak, std::fabs(y));
+        }
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    first.join();
+    second.join();
+    third.join();
+    std::printf("%ld blocks, %ld parameter sweeps, %ld reconfigurations, peak %.3f, %ld bad samples\n", blocks,
+                changes.load(), reconfigurations.load(), peak, bad);
+    return bad == 0 ? 0 : 1;
+}
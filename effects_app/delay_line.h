@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+// Ring buffer of past samples for delay-based effects. The capacity is a power of two, so wrapping
+// is a mask instead of a modulo, and it is sized once, in the constructor, from the longest delay
+// the effect needs. Delays count back from the newest sample: tap(0) is the sample just written.
+class DelayLine
+{
+public:
+    // Room for delays up to maxDelay samples, plus the extra points the interpolating taps read
+    explicit DelayLine(size_t maxDelay)
+    {
+        size_t capacity = 1;
+        while (capacity < maxDelay + INTERPOLATION_MARGIN)
+            capacity <<= 1;
+        buffer_.assign(capacity, 0.0f);
+        mask_ = capacity - 1;
+    }
+
+    void clear() { std::fill(buffer_.begin(), buffer_.end(), 0.0f); }
+    size_t getMaxDelay() const { return buffer_.size() - INTERPOLATION_MARGIN; }
+
+    void write(float x)
+    {
+        newest_ = (newest_ + 1) & mask_;
+        buffer_[newest_] = x;
+    }
+
+    float tap(size_t delay) const { return buffer_[(newest_ - delay) & mask_]; }
+
+    // Fractional delays. Linear is the cheapest and fine for slowly moving delays; 3rd-order
+    // Lagrange keeps the highs of a modulated tap (delay >= 1); allpass is flat in magnitude but
+    // carries state, so it suits a fixed or slowly changing delay read once per sample (see AllpassTap).
+    float linear(float delay) const
+    {
+        // int, not size_t: float <-> int converts in one instruction
+        int whole = static_cast<int>(delay);
+        float fraction = delay - whole;
+        float a = tap(whole), b = tap(whole + 1);
+        return a + fraction * (b - a);
+    }
+
+    float lagrange(float delay) const
+    {
+        int whole = static_cast<int>(delay);
+        float t = delay - whole;
+        float before = tap(whole - 1), at = tap(whole), after = tap(whole + 1), last = tap(whole + 2);
+        float tp1 = t + 1.0f, tm1 = t - 1.0f, tm2 = t - 2.0f;
+        return -before * t * tm1 * tm2 * (1.0f / 6.0f) + at * tp1 * tm1 * tm2 * 0.5f - after * tp1 * t * tm2 * 0.5f +
+               last * tp1 * t * tm1 * (1.0f / 6.0f);
+    }
+
+    // Block I/O in at most two contiguous copies each. These are plain memcpy rather than the tuner's
+    // cpuid-dispatched kernels (tuner_app/simd_kernels.h): effects_app does not link tuner_app, the
+    // kernels do arithmetic rather than copies, and memcpy already moves blocks with vector instructions.
+    // write(in, n) appends n samples, after which the i-th of them is tap(n - 1 - i); read(out, delay, n)
+    // copies the n samples ending at tap(delay), oldest first.
+    void write(const float* in, size_t n)
+    {
+        size_t start = (newest_ + 1) & mask_;
+        size_t first = std::min(n, buffer_.size() - start);
+        std::memcpy(buffer_.data() + start, in, first * sizeof(float));
+        std::memcpy(buffer_.data(), in + first, (n - first) * sizeof(float));
+        newest_ = (newest_ + n) & mask_;
+    }
+
+    void read(float* out, size_t delay, size_t n) const
+    {
+        size_t start = (newest_ - delay - n + 1) & mask_;
+        size_t first = std::min(n, buffer_.size() - start);
+        std::memcpy(out, buffer_.data() + start, first * sizeof(float));
+        std::memcpy(out + first, buffer_.data(), (n - first) * sizeof(float));
+    }
+
+    // For a feedback path, which has to read before it can write, without the copies: walks the
+    // next n slots in contiguous runs, split wherever the slots or the samples delay behind them
+    // wrap, and calls kernel(taps, slots, run) on each. slots[j] is where the j-th sample of the run
+    // goes and taps[j] the sample written delay samples before it (1 <= delay <= getMaxDelay()); the
+    // kernel fills the slots in order, so delays shorter than the run read what it just wrote.
+    template <typename Kernel>
+    void writeRuns(size_t delay, size_t n, Kernel kernel)
+    {
+        const size_t size = buffer_.size();
+        size_t slot = (newest_ + 1) & mask_;
+        size_t tap = (slot - delay) & mask_;
+        while (n > 0)
+        {
+            size_t run = std::min(n, std::min(size - slot, size - tap));
+            kernel(buffer_.data() + tap, buffer_.data() + slot, run);
+            n -= run;
+            slot = (slot + run) & mask_;
+            tap = (tap + run) & mask_;
+        }
+        newest_ = (slot - 1) & mask_;
+    }
+
+private:
+    static constexpr size_t INTERPOLATION_MARGIN = 3;
+
+    std::vector<float> buffer_;
+    size_t mask_ = 0;
+    size_t newest_ = 0;
+};
+
+// First-order allpass interpolation of a DelayLine: y = a*x[d] + x[d+1] - a*y[-1] with
+// a = (1 - f)/(1 + f) for a delay of d + f. Call it once per sample, after the write.
+class AllpassTap
+{
+public:
+    float read(const DelayLine& line, float delay)
+    {
+        int whole = static_cast<int>(delay);
+        float fraction = delay - whole;
+        float a = (1.0f - fraction) / (1.0f + fraction);
+        previous_ = a * line.tap(whole) + line.tap(whole + 1) - a * previous_;
+        return previous_;
+    }
+
+    void reset() { previous_ = 0.0f; }
+
+private:
+    float previous_ = 0.0f;
+};
@@ -1,64 +1,208 @@
 #include "effect_chain.h"
+#include <algorithm>
 
 // Wrapper
 EffectWrapper::EffectWrapper(std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled)
     : effect_(std::move(effect)), name_(name), enabled_(enabled) {}
 
-float EffectWrapper::process(float inputSample)
+float EffectWrapper::process(float inputSample) const
 {
     return (enabled_ && effect_) ? effect_->process(inputSample) : inputSample;
 }
 
+void EffectWrapper::processBlock(const float* in, float* out, size_t n) const
+{
+    if (enabled_ && effect_)
+        effect_->processBlock(in, out, n);
+    else if (in != out)
+        std::copy(in, in + n, out);
+}
+
 void EffectWrapper::setEnabled(bool state) { enabled_ = state; }
 bool EffectWrapper::isEnabled() const { return enabled_; }
 std::shared_ptr<AudioEffect> EffectWrapper::getEffect() const { return effect_; }
 std::string EffectWrapper::getName() const { return name_; }
 
 // Chain
-EffectChain::EffectChain(float inputGain) : inputGain_(inputGain) {}
+EffectChain::EffectChain(float inputGain) : effects_(new EffectList()), audioEpoch_(0), inputGain_(inputGain) {}
+
+EffectChain::~EffectChain()
+{
+    for (const Retired& retired : retired_)
+        delete retired.effects;
+    delete effects_.load();
+}
+
+// The epoch is bumped to odd before the snapshot is loaded and back to even after the block, both
+// sequentially consistent, so a control thread that swapped the pointer and then reads the epoch
+// knows whether the audio thread could still hold the old snapshot
+const EffectChain::EffectList* EffectChain::enter()
+{
+    audioEpoch_.fetch_add(1);
+    return effects_.load();
+}
+
+void EffectChain::leave()
+{
+    audioEpoch_.fetch_add(1);
+}
 
 float EffectChain::process(float inputSample)
 {
-    float sample = inputSample * inputGain_;
-    for (auto& wrapper : effects_)
+    const EffectList* effects = enter();
+    inputGain_.beginBlock();
+    float sample = inputSample * inputGain_.next();
+    for (const auto& wrapper : *effects)
         sample = wrapper.process(sample);
+    leave();
     return sample;
 }
 
+void EffectChain::processBlock(const float* in, float* out, size_t n)
+{
+    const EffectList* effects = enter();
+    inputGain_.beginBlock();
+    if (inputGain_.isSmoothing())
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = in[i] * inputGain_.next();
+    }
+    else
+    {
+        const float gain = inputGain_.current();
+        for (size_t i = 0; i < n; ++i)
+            out[i] = in[i] * gain;
+    }
+    for (const auto& wrapper : *effects)
+        wrapper.processBlock(out, out, n);
+    leave();
+}
+
+void EffectChain::update(const std::function<void(EffectList&)>& edit)
+{
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    EffectList* next = new EffectList(*effects_.load());
+    edit(*next);
+    const EffectList* previous = effects_.exchange(next);
+    retired_.push_back({previous, audioEpoch_.load()});
+    reclaimLocked();
+}
+
+void EffectChain::reclaim()
+{
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    reclaimLocked();
+}
+
+// A snapshot retired while the epoch was even was not in use; one retired during a block is free
+// once the epoch has moved on, since the next block loads the newer pointer
+void EffectChain::reclaimLocked()
+{
+    std::uint64_t epoch = audioEpoch_.load();
+    auto done = std::remove_if(retired_.begin(), retired_.end(), [epoch](const Retired& retired)
+    {
+        if (retired.epoch % 2 != 0 && retired.epoch == epoch)
+            return false;
+        delete retired.effects;
+        return true;
+    });
+    retired_.erase(done, retired_.end());
+}
+
 void EffectChain::addEffect(std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled)
 {
-    effects_.emplace_back(effect, name, enabled);
+    update([&](EffectList& effects) { effects.emplace_back(effect, name, enabled); });
 }
 
-void EffectChain::setInputGain(float gain) { inputGain_ = gain; }
-float EffectChain::getInputGain() const { return inputGain_; }
+void EffectChain::insertEffect(size_t index, std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled)
+{
+    update([&](EffectList& effects)
+    {
+        index = std::min(index, effects.size());
+        effects.insert(effects.begin() + index, EffectWrapper(effect, name, enabled));
+    });
+}
+
+void EffectChain::removeEffect(size_t index)
+{
+    update([&](EffectList& effects)
+    {
+        if (index < effects.size())
+            effects.erase(effects.begin() + index);
+    });
+}
+
+void EffectChain::moveEffect(size_t from, size_t to)
+{
+    update([&](EffectList& effects)
+    {
+        if (from >= effects.size() || to >= effects.size())
+            return;
+        if (from < to)
+            std::rotate(effects.begin() + from, effects.begin() + from + 1, effects.begin() + to + 1);
+        else
+            std::rotate(effects.begin() + to, effects.begin() + from, effects.begin() + from + 1);
+    });
+}
+
+void EffectChain::setInputGain(float gain) { inputGain_.set(gain); }
+float EffectChain::getInputGain() const { return inputGain_.get(); }
 
 void EffectChain::enableEffect(size_t index, bool enabled)
 {
-    if (index < effects_.size())
-        effects_[index].setEnabled(enabled);
+    update([&](EffectList& effects)
+    {
+        if (index < effects.size())
+            effects[index].setEnabled(enabled);
+    });
 }
 
 void EffectChain::toggleEffect(size_t index)
 {
-    if (index < effects_.size())
-        effects_[index].setEnabled(!effects_[index].isEnabled());
+    update([&](EffectList& effects)
+    {
+        if (index < effects.size())
+            effects[index].setEnabled(!effects[index].isEnabled());
+    });
 }
 
+// Only control threads replace or delete snapshots, so under updateMutex_ the current one is stable
 std::shared_ptr<AudioEffect> EffectChain::getEffect(size_t index) const
 {
-    if (index < effects_.size())
-        return effects_[index].getEffect();
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    const EffectList& effects = *effects_.load();
+    if (index < effects.size())
+        return effects[index].getEffect();
     return nullptr;
 }
 
+int EffectChain::findEffect(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    const EffectList& effects = *effects_.load();
+    for (size_t i = 0; i < effects.size(); ++i)
+    {
+        if (effects[i].getName() == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+size_t EffectChain::getEffectCount() const
+{
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    return effects_.load()->size();
+}
+
 void EffectChain::listEffects() const
 {
-    std::cout << "Input Gain: " << inputGain_ << "\n";
-    std::cout << "EffectChain [" << effects_.size() << " effects]:\n";
-    for (size_t i = 0; i < effects_.size(); ++i)
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    const EffectList& effects = *effects_.load();
+    std::cout << "Input Gain: " << getInputGain() << "\n";
+    std::cout << "EffectChain [" << effects.size() << " effects]:\n";
+    for (size_t i = 0; i < effects.size(); ++i)
     {
-        std::cout << " - [" << i + 1 << "] " << effects_[i].getName()
-                  << " - " << (effects_[i].isEnabled() ? "\033[32mEnabled\033[0m" : "\033[31mDisabled\033[0m") << "\n";
+        std::cout << " - [" << i + 1 << "] " << effects[i].getName()
+                  << " - " << (effects[i].isEnabled() ? "\033[32mEnabled\033[0m" : "\033[31mDisabled\033[0m") << "\n";
     }
 }
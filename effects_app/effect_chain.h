@@ -4,12 +4,17 @@
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <functional>
 
 class EffectWrapper
 {
 public:
     EffectWrapper(std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled = true);
-    float process(float inputSample);
+    float process(float inputSample) const;
+    void processBlock(const float* in, float* out, size_t n) const;
     void setEnabled(bool state);
     bool isEnabled() const;
     std::shared_ptr<AudioEffect> getEffect() const;
@@ -20,22 +25,62 @@ private:
     std::string name_;
     bool enabled_;
 };
-// A composite effect that contains and manages a chain of multiple effects
+// A composite effect that contains and manages a chain of multiple effects.
+// The audio thread walks an immutable snapshot of the effect list. Every change (add, remove,
+// move, enable) copies the current snapshot, edits the copy and publishes it with one atomic
+// pointer swap, so the audio thread never locks, never sees a half-edited list and never frees
+// anything. Replaced snapshots are retired and deleted by the control threads once the audio
+// thread has finished every block that might still be using them. process()/processBlock() must
+// be called from one audio thread at a time; everything else from any thread.
 class EffectChain : public AudioEffect
 {
 public:
     EffectChain(float inputGain = 1.0f);
+    ~EffectChain() override;
+    EffectChain(const EffectChain&) = delete;
+    EffectChain& operator=(const EffectChain&) = delete;
+
     float process(float inputSample) override;
+    // Input gain, then every enabled effect over the whole block in place: one virtual call per
+    // effect per block instead of per sample
+    void processBlock(const float* in, float* out, size_t n) override;
     void addEffect(std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled = true);
+    void insertEffect(size_t index, std::shared_ptr<AudioEffect> effect, const std::string& name, bool enabled = true);
+    void removeEffect(size_t index);
+    // Moves the effect at from so that it ends up at position to
+    void moveEffect(size_t from, size_t to);
     void setInputGain(float gain);
     float getInputGain() const;
     void enableEffect(size_t index, bool enabled);
     void toggleEffect(size_t index);
     // Gets the underlying AudioEffect by index
     std::shared_ptr<AudioEffect> getEffect(size_t index) const;
+    // Index of the first effect with this name, -1 if there is none
+    int findEffect(const std::string& name) const;
+    size_t getEffectCount() const;
+    // Deletes the retired snapshots the audio thread is done with; changes do this too
+    void reclaim();
     void listEffects() const;
 
 private:
-    std::vector<EffectWrapper> effects_;
-    float inputGain_;
+    using EffectList = std::vector<EffectWrapper>;
+
+    struct Retired
+    {
+        const EffectList* effects;
+        std::uint64_t epoch;
+    };
+
+    // Audio thread: the snapshot to use until leave()
+    const EffectList* enter();
+    void leave();
+    // Control threads: copy the current snapshot, apply edit, publish the copy
+    void update(const std::function<void(EffectList&)>& edit);
+    void reclaimLocked();
+
+    std::atomic<const EffectList*> effects_;
+    std::atomic<std::uint64_t> audioEpoch_; // odd while the audio thread is inside process/processBlock
+    mutable std::mutex updateMutex_;        // serializes the control threads; the audio thread never takes it
+    std::vector<Retired> retired_;
+    SmoothedParam inputGain_;
 };
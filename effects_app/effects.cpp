@@ -1,76 +1,175 @@
 #include "effects.h"
+#include <algorithm>
 #include <cmath>
 
+// --- Per-sample adapter ---
+void AudioEffect::processBlock(const float* in, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = process(in[i]);
+}
+
 // --- Distortion ---
 DistortionEffect::DistortionEffect(float gain, float mix) : gain_(gain), mix_(mix) {}
 
-void DistortionEffect::setGain(float gain) { gain_ = gain; }
-void DistortionEffect::setMix(float mix) { mix_ = mix; }
+void DistortionEffect::setGain(float gain) { gain_.set(gain); }
+void DistortionEffect::setMix(float mix) { mix_.set(mix); }
 
-float DistortionEffect::getGain() const { return gain_; }
-float DistortionEffect::getMix() const { return mix_; }
+float DistortionEffect::getGain() const { return gain_.get(); }
+float DistortionEffect::getMix() const { return mix_.get(); }
 
 float DistortionEffect::process(float inputSample)
 {
-    float x = gain_ * inputSample;
+    gain_.beginBlock();
+    mix_.beginBlock();
+    float mix = mix_.next();
+    float x = gain_.next() * inputSample;
     float threshold = 0.5f;
     float distorted = (x > threshold) ? threshold : (x < -threshold ? -threshold : x);
-    return mix_ * distorted + (1.0f - mix_) * inputSample;
+    return mix * distorted + (1.0f - mix) * inputSample;
+}
+
+// Same hard clip as process(), branch-free so the loop vectorizes while no parameter is ramping
+void DistortionEffect::processBlock(const float* in, float* out, size_t n)
+{
+    const float threshold = 0.5f;
+    gain_.beginBlock();
+    mix_.beginBlock();
+    if (!gain_.isSmoothing() && !mix_.isSmoothing())
+    {
+        const float gain = gain_.current(), mix = mix_.current();
+        for (size_t i = 0; i < n; ++i)
+        {
+            float distorted = std::min(threshold, std::max(-threshold, gain * in[i]));
+            out[i] = mix * distorted + (1.0f - mix) * in[i];
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        float gain = gain_.next(), mix = mix_.next();
+        float distorted = std::min(threshold, std::max(-threshold, gain * in[i]));
+        out[i] = mix * distorted + (1.0f - mix) * in[i];
+    }
 }
 
 // --- Chorus ---
+// The modulated tap is read with 3rd-order Lagrange interpolation, so the delay sweeps smoothly
+// instead of stepping a whole sample at a time
 ChorusEffect::ChorusEffect(unsigned int sampleRate, float rate, float depth)
-    : rate_(rate), depth_(depth), delayBase_(0.01f), sampleRate_(sampleRate), phase_(0.0f), writeIndex_(0)
+    : rate_(rate), depth_(std::min(depth, MAX_DEPTH)), delayBase_(0.01f), phase_(0.0f), sampleRate_(sampleRate),
+      line_(static_cast<size_t>(std::ceil((delayBase_ + MAX_DEPTH) * sampleRate)))
 {
-    buffer_.resize(sampleRate);
 }
 
-void ChorusEffect::setRate(float rate) { rate_ = rate; }
-void ChorusEffect::setDepth(float depth) { depth_ = (depth / 100); }
+void ChorusEffect::setRate(float rate) { rate_.set(rate); }
+void ChorusEffect::setDepth(float depth) { depth_.set(std::min(std::max(depth / 100, 0.0f), MAX_DEPTH)); }
 
-float ChorusEffect::getRate() const { return rate_; }
-float ChorusEffect::getDepth() const { return depth_; }
+float ChorusEffect::getRate() const { return rate_.get(); }
+float ChorusEffect::getDepth() const { return depth_.get(); }
 
 float ChorusEffect::process(float inputSample)
 {
-    float delayTime = delayBase_ + depth_ * std::sin(2.0f * 3.141592f * phase_);
-    int delaySamples = static_cast<int>(delayTime * sampleRate_);
+    rate_.beginBlock();
+    depth_.beginBlock();
+    float delayTime = delayBase_ + depth_.next() * std::sin(2.0f * 3.141592f * phase_);
+    float delaySamples = std::max(1.0f, delayTime * sampleRate_);
 
-    phase_ += rate_ / sampleRate_;
+    phase_ += rate_.next() / sampleRate_;
     if (phase_ >= 1.0f) phase_ -= 1.0f;
 
-    buffer_[writeIndex_] = inputSample;
-    int readIndex = (writeIndex_ - delaySamples + buffer_.size()) % buffer_.size();
-    float delayed = buffer_[readIndex];
+    line_.write(inputSample);
+    return 0.5f * (inputSample + line_.lagrange(delaySamples));
+}
 
-    writeIndex_ = (writeIndex_ + 1) % buffer_.size();
-    return 0.5f * (inputSample + delayed);
+// The LFO is a phasor rotated once per sample instead of a sin() call per sample; it is
+// re-seeded from phase_ at every block so rounding cannot build up. The rate only moves the
+// LFO, so it steps per block; the depth ramps per sample.
+void ChorusEffect::processBlock(const float* in, float* out, size_t n)
+{
+    rate_.beginBlock();
+    depth_.beginBlock();
+    const float twoPi = 2.0f * 3.141592f;
+    const float step = rate_.current() / sampleRate_;
+    const float stepSin = std::sin(twoPi * step), stepCos = std::cos(twoPi * step);
+    float lfoSin = std::sin(twoPi * phase_), lfoCos = std::cos(twoPi * phase_);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        float delaySamples = std::max(1.0f, (delayBase_ + depth_.next() * lfoSin) * sampleRate_);
+        float x = in[i];
+        line_.write(x);
+        out[i] = 0.5f * (x + line_.lagrange(delaySamples));
+
+        float nextSin = lfoSin * stepCos + lfoCos * stepSin;
+        lfoCos = lfoCos * stepCos - lfoSin * stepSin;
+        lfoSin = nextSin;
+    }
+
+    phase_ += step * n;
+    phase_ -= std::floor(phase_);
+    rate_.skip(static_cast<int>(n));
 }
 
 // --- Delay ---
-DelayEffect::DelayEffect(unsigned int sampleRate, float delayTime, float feedback)
-    : sampleRate_(sampleRate), delayTime_(delayTime), feedback_(feedback), writeIndex_(0)
+// A delay-time change glides over this long, like a tape delay, instead of clicking
+#define DELAY_GLIDE_SECONDS 0.1f
+
+static float clampDelaySamples(float dt, unsigned int sampleRate)
 {
-    int delaySamples = static_cast<int>(delayTime * sampleRate_);
-    buffer_.resize(delaySamples);
+    return std::max(1.0f, std::round(std::min(dt, DelayEffect::MAX_DELAY_TIME) * sampleRate));
 }
 
-void DelayEffect::setDelayTime(float dt)
+DelayEffect::DelayEffect(unsigned int sampleRate, float delayTime, float feedback)
+    : sampleRate_(sampleRate), delaySamples_(clampDelaySamples(delayTime, sampleRate), static_cast<int>(DELAY_GLIDE_SECONDS * sampleRate)),
+      feedback_(feedback), line_(static_cast<size_t>(std::ceil(MAX_DELAY_TIME * sampleRate)))
 {
-    delayTime_ = dt;
-    int delaySamples = static_cast<int>(delayTime_ * sampleRate_);
-    if (delaySamples < 1) delaySamples = 1;
-    buffer_.assign(delaySamples, 0.0f);
-    writeIndex_ = 0;
 }
 
-float DelayEffect::getDelayTime() const { return delayTime_; }
+void DelayEffect::setDelayTime(float dt) { delaySamples_.set(clampDelaySamples(dt, sampleRate_)); }
+
+float DelayEffect::getDelayTime() const { return delaySamples_.get() / sampleRate_; }
 
+// The tap is read before the new sample goes in, so a delay of d samples is tap d - 1
 float DelayEffect::process(float inputSample)
 {
-    float delayed = buffer_[writeIndex_];
-    buffer_[writeIndex_] = inputSample + delayed * feedback_;
-
-    writeIndex_ = (writeIndex_ + 1) % buffer_.size();
+    delaySamples_.beginBlock();
+    float delayed = line_.linear(delaySamples_.next() - 1.0f);
+    line_.write(inputSample + delayed * feedback_);
     return inputSample + delayed * 0.5f;
 }
+
+// At a steady, whole-sample delay the taps trail the slots by a constant, so the block is a few
+// plain loops straight over the line's memory. While the delay glides every sample reads at its
+// own fractional position.
+void DelayEffect::processBlock(const float* in, float* out, size_t n)
+{
+    const float feedback = feedback_;
+    delaySamples_.beginBlock();
+    if (delaySamples_.isSmoothing())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            float delayed = line_.linear(delaySamples_.next() - 1.0f);
+            line_.write(in[i] + delayed * feedback);
+            out[i] = in[i] + delayed * 0.5f;
+        }
+        return;
+    }
+
+    line_.writeRuns(static_cast<size_t>(delaySamples_.current()), n, [&in, &out, feedback](const float* taps, float* slots, size_t run)
+    {
+        const float* source = in;
+        float* target = out;
+        for (size_t i = 0; i < run; ++i)
+        {
+            float x = source[i];
+            float delayed = taps[i];
+            slots[i] = x + delayed * feedback;
+            target[i] = x + delayed * 0.5f;
+        }
+        in += run;
+        out += run;
+    });
+}
@@ -2,14 +2,24 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <cstddef>
+#include "smoothed_param.h"
+#include "delay_line.h"
 
 class AudioEffect
 {
 public:
     virtual ~AudioEffect() = default;
     virtual float process(float inputSample) = 0;
+
+    // Process n samples at once; out may be the same buffer as in. The default calls process()
+    // per sample, effects override it with a loop the compiler can keep in registers and vectorize.
+    virtual void processBlock(const float* in, float* out, size_t n);
 };
 
+// Parameter setters and getters may be called from any thread while the audio thread processes:
+// they only touch SmoothedParam targets, which process()/processBlock() pick up at the next block.
+
 class DistortionEffect : public AudioEffect
 {
 public:
@@ -19,41 +29,51 @@ public:
     float getGain() const;
     float getMix() const;
     float process(float inputSample) override;
+    void processBlock(const float* in, float* out, size_t n) override;
 
 private:
-    float gain_;
-    float mix_;
+    SmoothedParam gain_;
+    SmoothedParam mix_;
 };
 
 class ChorusEffect : public AudioEffect
 {
 public:
+    // Deepest modulation, in seconds either side of the 10 ms base delay; the delay line is sized for it
+    static constexpr float MAX_DEPTH = 0.01f;
+
     ChorusEffect(unsigned int sampleRate, float rate = 0.25f, float depth = 0.002f);
     void setRate(float rate);
     void setDepth(float depth);
     float getRate() const;
     float getDepth() const;
     float process(float inputSample) override;
+    void processBlock(const float* in, float* out, size_t n) override;
 
 private:
-    float rate_, depth_, delayBase_, phase_;
+    SmoothedParam rate_, depth_;
+    float delayBase_, phase_;
     unsigned int sampleRate_;
-    std::vector<float> buffer_;
-    int writeIndex_;
+    DelayLine line_;
 };
 
 class DelayEffect : public AudioEffect
 {
 public:
+    // Longest delay time; the memory for it is allocated once, in the constructor
+    static constexpr float MAX_DELAY_TIME = 1.0f;
+
     DelayEffect(unsigned int sampleRate, float delayTime = 0.15f, float feedback = 0.6f);
+    // Clamped to one sample..MAX_DELAY_TIME. The delay glides to the new time instead of jumping.
     void setDelayTime(float dt);
     float getDelayTime() const;
     float process(float inputSample) override;
+    void processBlock(const float* in, float* out, size_t n) override;
 
 private:
     unsigned int sampleRate_;
-    float delayTime_, feedback_;
-    std::vector<float> buffer_;
-    int writeIndex_;
+    SmoothedParam delaySamples_;
+    float feedback_;
+    DelayLine line_;
 };
 
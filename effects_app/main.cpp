@@ -14,6 +14,7 @@ void userInterface(std::shared_ptr<EffectChain> chain)
         std::cout << " \033[33mG\033[0m: Set Input Gain\n";
         std::cout << " \033[33m1\033[0m: Toggle Dist | \033[33m2\033[0m: Toggle Chorus | \033[33m3\033[0m: Toggle Delay\n";
         std::cout << " \033[33mD\033[0m: Dist Params | \033[33mC\033[0m: Chorus Params | \033[33mL\033[0m: Delay Params\n";
+        std::cout << " \033[33mM\033[0m: Move Effect\n";
         std::cout << " \033[33mQ\033[0m: Quit\n> ";
         std::getline(std::cin, input);
 
@@ -22,15 +23,15 @@ void userInterface(std::shared_ptr<EffectChain> chain)
 
         if (input == "1")
         {
-            chain->toggleEffect(0);
+            chain->toggleEffect(chain->findEffect("Distortion"));
         }
         else if (input == "2")
         {
-            chain->toggleEffect(1);
+            chain->toggleEffect(chain->findEffect("Chorus"));
         }
         else if (input == "3")
         {
-            chain->toggleEffect(2);
+            chain->toggleEffect(chain->findEffect("Delay"));
         }
         else if (input == "G")
         {
@@ -48,7 +49,7 @@ void userInterface(std::shared_ptr<EffectChain> chain)
         // Distortion
         else if (input == "D")
         {
-            auto dist = std::dynamic_pointer_cast<DistortionEffect>(chain->getEffect(0));
+            auto dist = std::dynamic_pointer_cast<DistortionEffect>(chain->getEffect(chain->findEffect("Distortion")));
             if (!dist)
                 continue;
 
@@ -93,7 +94,7 @@ void userInterface(std::shared_ptr<EffectChain> chain)
         // Chorus
         else if (input == "C")
         {
-            auto chorus = std::dynamic_pointer_cast<ChorusEffect>(chain->getEffect(1));
+            auto chorus = std::dynamic_pointer_cast<ChorusEffect>(chain->getEffect(chain->findEffect("Chorus")));
             if (!chorus)
                 continue;
 
@@ -138,7 +139,7 @@ void userInterface(std::shared_ptr<EffectChain> chain)
         // Delay
         else if (input == "L")
         {
-            auto delay = std::dynamic_pointer_cast<DelayEffect>(chain->getEffect(2));
+            auto delay = std::dynamic_pointer_cast<DelayEffect>(chain->getEffect(chain->findEffect("Delay")));
             if (!delay)
                 continue;
 
@@ -166,6 +167,19 @@ void userInterface(std::shared_ptr<EffectChain> chain)
                 }
             }
         }
+        // Reorder; the audio thread switches to the new order at its next block
+        else if (input == "M")
+        {
+            std::cout << "Move effect to position (from to) [1-" << chain->getEffectCount() << "]: ";
+            std::string valStr;
+            std::getline(std::cin, valStr);
+            std::stringstream ss(valStr);
+            size_t from, to;
+            if (ss >> from >> to && from >= 1 && to >= 1 && from <= chain->getEffectCount() && to <= chain->getEffectCount())
+                chain->moveEffect(from - 1, to - 1);
+            else
+                std::cout << "\033[1;31mInvalid or out of range!\033[0m\n";
+        }
         else if (input == "Q")
         {
             running = false;
@@ -177,6 +191,7 @@ void userInterface(std::shared_ptr<EffectChain> chain)
         }
 
         std::cout << "\n--------------------------------------------------\n";
+        chain->reclaim();
         chain->listEffects();
     }
 }
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+
+// An effect parameter that the UI thread may set at any time while the audio thread processes.
+// set() only publishes the new target through an atomic; the audio thread picks it up at the next
+// block boundary (beginBlock()) and ramps to it linearly over rampSamples, one next() per sample,
+// so a change never steps the signal. Nothing here allocates or locks.
+class SmoothedParam
+{
+public:
+    explicit SmoothedParam(float value, int rampSamples = 1024)
+        : target_(value), goal_(value), current_(value), step_(0.0f), remaining_(0), rampSamples_(rampSamples) {}
+
+    // Any thread
+    void set(float value) { target_.store(value, std::memory_order_relaxed); }
+    float get() const { return target_.load(std::memory_order_relaxed); }
+
+    // Audio thread: start ramping towards the newest target, if it changed
+    void beginBlock()
+    {
+        float target = target_.load(std::memory_order_relaxed);
+        if (target == goal_)
+            return;
+        goal_ = target;
+        remaining_ = rampSamples_ > 0 ? rampSamples_ : 1;
+        step_ = (goal_ - current_) / remaining_;
+    }
+
+    // Audio thread: value for the next sample
+    float next()
+    {
+        if (remaining_ > 0)
+        {
+            current_ = --remaining_ == 0 ? goal_ : current_ + step_;
+        }
+        return current_;
+    }
+
+    // Audio thread: move n samples along the ramp at once and return the value reached
+    float skip(int n)
+    {
+        if (remaining_ > n)
+        {
+            remaining_ -= n;
+            current_ += step_ * n;
+        }
+        else
+        {
+            remaining_ = 0;
+            current_ = goal_;
+        }
+        return current_;
+    }
+
+    // Audio thread: true while a ramp is in progress, i.e. next() is not constant
+    bool isSmoothing() const { return remaining_ > 0; }
+    float current() const { return current_; }
+
+private:
+    std::atomic<float> target_;
+    float goal_, current_, step_;
+    int remaining_, rampSamples_;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include "effects.h"
+#include <atomic>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+// One effect of a StaticChain, held by value; I keeps two stages of the same type apart
+template <size_t I, typename Effect>
+struct StaticStage
+{
+    template <typename Args>
+    explicit StaticStage(Args&& args) : effect(std::make_from_tuple<Effect>(std::forward<Args>(args))) {}
+
+    Effect effect;
+};
+
+template <typename Indices, typename... Effects>
+class StaticChainBase;
+
+template <size_t... I, typename... Effects>
+class StaticChainBase<std::index_sequence<I...>, Effects...> : public AudioEffect, protected StaticStage<I, Effects>...
+{
+protected:
+    template <typename... Args>
+    explicit StaticChainBase(Args&&... args) : StaticStage<I, Effects>(std::forward<Args>(args))... {}
+
+    // Each enabled stage in order, called on the concrete effect: no shared_ptr, no virtual dispatch
+    float processStages(std::uint32_t enabled, float sample)
+    {
+        ((sample = (enabled >> I & 1u) ? StaticStage<I, Effects>::effect.process(sample) : sample), ...);
+        return sample;
+    }
+
+    // Stage by stage, each running its own processBlock() in place over the whole block while it is
+    // still in L1. The stages are not fused into one per-sample loop: that would trade away each
+    // effect's block kernel (the vectorized distortion, the delay's run-split copy loop) for a chain
+    // of scalar bodies, and the bypass test would move from once per block into every sample.
+    void processStages(std::uint32_t enabled, float* block, size_t n)
+    {
+        ((enabled >> I & 1u ? StaticStage<I, Effects>::effect.processBlock(block, block, n) : void()), ...);
+    }
+};
+
+// A pedalboard whose effects and their order are fixed at compile time, for when the chain is never
+// rebuilt at runtime. The effects live inside the chain; each is built from a tuple of its
+// constructor arguments:
+//
+//     StaticChain<DistortionEffect, ChorusEffect, DelayEffect> board(3.0f, std::make_tuple(8.0f, 0.7f),
+//                                                                   std::make_tuple(48000u), std::make_tuple(48000u));
+//
+// Bypass flags are one atomic bitmask that processBlock() reads once per block, so a toggle from
+// the UI thread takes effect at the next block boundary and the stages themselves never branch on it.
+// Like EffectChain it is an AudioEffect, so it plugs into AudioPassthrough unchanged.
+template <typename... Effects>
+class StaticChain final : public StaticChainBase<std::index_sequence_for<Effects...>, Effects...>
+{
+    static_assert(sizeof...(Effects) <= 32, "bypass flags are one 32-bit mask");
+
+public:
+    static constexpr size_t SIZE = sizeof...(Effects);
+
+    template <typename... Args>
+    explicit StaticChain(float inputGain, Args&&... args)
+        : StaticChainBase<std::index_sequence_for<Effects...>, Effects...>(std::forward<Args>(args)...),
+          enabled_(SIZE == 32 ? ~0u : (1u << SIZE) - 1), inputGain_(inputGain)
+    {
+        static_assert(sizeof...(Args) == SIZE, "one argument tuple per effect");
+    }
+
+    float process(float inputSample) override
+    {
+        inputGain_.beginBlock();
+        return this->processStages(enabled_.load(std::memory_order_relaxed), inputSample * inputGain_.next());
+    }
+
+    void processBlock(const float* in, float* out, size_t n) override
+    {
+        inputGain_.beginBlock();
+        if (inputGain_.isSmoothing())
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = in[i] * inputGain_.next();
+        }
+        else
+        {
+            const float gain = inputGain_.current();
+            for (size_t i = 0; i < n; ++i)
+                out[i] = in[i] * gain;
+        }
+        this->processStages(enabled_.load(std::memory_order_relaxed), out, n);
+    }
+
+    // The effect at position I, e.g. to change its parameters
+    template <size_t I>
+    auto& get() { return StaticStage<I, std::tuple_element_t<I, std::tuple<Effects...>>>::effect; }
+
+    // Any thread
+    void setInputGain(float gain) { inputGain_.set(gain); }
+    float getInputGain() const { return inputGain_.get(); }
+    // Indices past the last effect are ignored, as in EffectChain
+    void enableEffect(size_t index, bool enabled)
+    {
+        if (index >= SIZE)
+            return;
+        if (enabled)
+            enabled_.fetch_or(1u << index, std::memory_order_relaxed);
+        else
+            enabled_.fetch_and(~(1u << index), std::memory_order_relaxed);
+    }
+    void toggleEffect(size_t index)
+    {
+        if (index < SIZE)
+            enabled_.fetch_xor(1u << index, std::memory_order_relaxed);
+    }
+    bool isEnabled(size_t index) const { return index < SIZE && (enabled_.load(std::memory_order_relaxed) >> index & 1u); }
+
+private:
+    std::atomic<std::uint32_t> enabled_;
+    SmoothedParam inputGain_;
+};
@@ -0,0 +1,125 @@
+#include "alloc_counter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace
+{
+    thread_local std::size_t allocationCount = 0;
+    std::atomic<std::size_t> violationCount{0};
+}
+
+#ifndef NDEBUG
+// Counting replacements for the global allocation functions. The array, nothrow and over-aligned
+// forms are replaced too so that no allocation path bypasses the counter.
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return ::operator new(size, std::nothrow);
+}
+
+// Over-aligned types (alignas above the default new alignment) come through these. Windows has no
+// posix_memalign and its aligned blocks must go back through _aligned_free.
+static void *alignedAllocate(std::size_t size, std::align_val_t alignment)
+{
+    ++allocationCount;
+    std::size_t bytes = size ? size : 1;
+#ifdef _WIN32
+    return _aligned_malloc(bytes, static_cast<std::size_t>(alignment));
+#else
+    void *p = nullptr;
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    return posix_memalign(&p, align, bytes) == 0 ? p : nullptr;
+#endif
+}
+
+static void alignedFree(void *p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *p = alignedAllocate(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return alignedAllocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return alignedAllocate(size, alignment);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+#endif
+
+std::size_t AllocationCounter::threadAllocations()
+{
+    return allocationCount;
+}
+
+std::size_t AllocationCounter::violations()
+{
+    return violationCount.load(std::memory_order_relaxed);
+}
+
+AllocationGuard::AllocationGuard() : startCount(allocationCount) {}
+
+std::size_t AllocationGuard::allocations() const
+{
+    return allocationCount - startCount;
+}
+
+AllocationGuard::~AllocationGuard()
+{
+#ifndef NDEBUG
+    if (allocationCount != startCount)
+        violationCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,33 @@
+#include <atomic>
+#include <cstddef>
+#pragma once
+
+// Debug-mode heap allocation tracking used to prove the audio callback is allocation-free.
+// In debug builds (NDEBUG not defined) the global operator new is replaced with a counting version.
+// Release builds keep the standard allocator: the counter then stays at 0 and guards never record a
+// violation, though the functions below still exist and cost a thread-local read each.
+namespace AllocationCounter
+{
+    // Number of heap allocations made so far by the calling thread
+    std::size_t threadAllocations();
+
+    // Number of AllocationGuard scopes that saw at least one allocation
+    std::size_t violations();
+}
+
+// Scope guard: records a violation if the current thread allocates while it is alive
+class AllocationGuard
+{
+public:
+    AllocationGuard();
+    ~AllocationGuard();
+
+    AllocationGuard(const AllocationGuard &) = delete;
+    AllocationGuard &operator=(const AllocationGuard &) = delete;
+
+    // Allocations the current thread made since the guard was created (always 0 in release builds)
+    std::size_t allocations() const;
+
+private:
+    std::size_t startCount;
+};
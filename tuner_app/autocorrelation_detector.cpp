@@ -0,0 +1,337 @@
+#include "autocorrelation_detector.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#define PI 3.14159265358979323846
+
+// A chromatic candidate must reach this fraction of the strongest peak to be preferred
+#define PEAK_THRESHOLD 0.9f
+// Normalised correlation below which a local maximum is not considered a period candidate
+#define PEAK_FLOOR 0.3f
+
+AutocorrelationDetector::AutocorrelationDetector(float sampleRate, int maxFrameSize)
+    : FrequencyDetector(sampleRate), decimator(maxFrameSize)
+{
+    configure(maxFrameSize);
+}
+
+PitchEngine AutocorrelationDetector::getEngine() const
+{
+    return PitchEngine::Autocorrelation;
+}
+
+void AutocorrelationDetector::allocate(int frameSize)
+{
+    windowed.assign(frameSize, 0.0f);
+    decimator.configure(frameSize);
+    decimated.assign(frameSize, 0.0f);
+    coarse.assign(frameSize + 2, 0.0f);
+
+    // Slot 0 starts empty; the full frame size is always prepared
+    hannTables.assign(1, HannTable());
+    hannTables[0].window.assign(frameSize, 0.0f);
+    hannTables[0].correlation.assign(frameSize, 0.0f);
+    activeTable = 0;
+    prepare(frameSize);
+}
+
+void AutocorrelationDetector::prepare(int size)
+{
+    for (std::size_t t = 1; t < hannTables.size(); ++t)
+        if (hannTables[t].size == size)
+            return;
+
+    HannTable table;
+    table.window.assign(size, 0.0f);
+    table.correlation.assign(size, 0.0f);
+    buildWindow(table, size);
+    hannTables.push_back(std::move(table));
+}
+
+void AutocorrelationDetector::buildWindow(HannTable &table, int size)
+{
+    for (int i = 0; i < size; ++i)
+        table.window[i] = 0.5f * (1 - std::cos(2 * PI * i / (size - 1)));
+    table.size = size;
+
+    // Normalised autocorrelation of the window itself, used to undo its taper
+    computeCorrelationFFT(table.window.data(), size, size - 1);
+    for (int lag = 0; lag < size; ++lag)
+        table.correlation[lag] = correlation[lag] / correlation[0];
+}
+
+void AutocorrelationDetector::applyWindow(const float *input, int size)
+{
+    if (hannTables[activeTable].size != size)
+    {
+        activeTable = 0;
+        for (std::size_t t = 1; t < hannTables.size(); ++t)
+            if (hannTables[t].size == size)
+                activeTable = static_cast<int>(t);
+        if (activeTable == 0 && hannTables[0].size != size)
+            buildWindow(hannTables[0], size);
+    }
+
+    //Hann windowing to reduce spectral leakage
+    activeKernels().multiply(input, hannTables[activeTable].window.data(), windowed.data(), size);
+}
+
+int AutocorrelationDetector::decimateFrame(int size, int minLag)
+{
+    int factor = HalfBandDecimator::chooseFactor(sampleRate, sampleRate / minLag);
+    while (factor > 1 && minLag / factor < MIN_COARSE_LAG)
+        factor /= 2;
+    decimatedSize = decimator.process(windowed.data(), size, factor, decimated.data());
+    return factor;
+}
+
+int AutocorrelationDetector::refineLag(int size, int lo, int hi, int minLag, int maxLag, float energy)
+{
+    lo = std::max(lo, minLag);
+    hi = std::min(hi, maxLag);
+    computeCorrelationDirect(windowed.data(), size, lo, hi);
+
+    int best = lo;
+    for (int lag = lo; lag <= hi; ++lag)
+    {
+        correlation[lag] = normalizedCorrelation(lag, correlation[lag], energy);
+        if (correlation[lag] > correlation[best])
+            best = lag;
+    }
+    return best;
+}
+
+PitchResult AutocorrelationDetector::estimate(const float *input, int size)
+{
+    applyWindow(input, size);
+    return isChromatic() ? detectChromatic(size) : detectTarget(size);
+}
+
+// Taper-compensated, energy-normalised autocorrelation
+bool AutocorrelationDetector::periodicity(const float *input, int size, int minLag, int maxLag)
+{
+    applyWindow(input, size);
+    computeCorrelation(windowed.data(), size, minLag - 1, maxLag + 1);
+    computeCorrelationDirect(windowed.data(), size, 0, 0);
+
+    float energy = correlation[0];
+    if (energy <= 0.0f)
+        return false;
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+        score[lag] = normalizedCorrelation(lag, correlation[lag], energy);
+    return true;
+}
+
+// Search +-1.5x around the selected target and fold harmonics back onto it.
+// Lags are compared taper-compensated: the Hann window's own falloff would otherwise pull the peak
+// towards shorter lags, by several lags (tens of cents) at the low strings.
+PitchResult AutocorrelationDetector::detectTarget(int size)
+{
+    PitchResult result;
+    int minLag, maxLag;
+    if (!searchRange(size, minLag, maxLag))
+        return result;
+
+    computeCorrelationDirect(windowed.data(), size, 0, 0);
+    float energy = correlation[0];
+    if (energy <= 0.0f)
+        return result;
+
+    float maxCorr = 0;
+    int bestLag = -1;
+    int factor = method == CorrelationMethod::Direct ? decimateFrame(size, minLag) : 1;
+    if (factor == 1)
+    {
+        // Autocorrelation to find periodicity
+        computeCorrelation(windowed.data(), size, minLag, maxLag);
+        for (int lag = minLag; lag <= maxLag; ++lag)
+        {
+            float value = normalizedCorrelation(lag, correlation[lag], energy);
+            if (value > maxCorr)
+            {
+                maxCorr = value;
+                bestLag = lag;
+            }
+        }
+    }
+    else
+    {
+        // Coarse pass at the decimated rate: keep the strongest few local maxima
+        int coarseMin = std::max(1, minLag / factor);
+        int coarseMax = std::min(decimatedSize - 2, maxLag / factor + 1);
+        computeCorrelationDirect(decimated.data(), decimatedSize, 0, 0);
+        float coarseEnergy = correlation[0];
+        if (coarseEnergy <= 0.0f)
+            return result;
+        computeCorrelationDirect(decimated.data(), decimatedSize, coarseMin - 1, coarseMax + 1);
+        for (int lag = coarseMin - 1; lag <= coarseMax + 1; ++lag)
+            coarse[lag] = normalizedCorrelation(lag * factor, correlation[lag], coarseEnergy);
+
+        int count = 0;
+        for (int lag = coarseMin; lag <= coarseMax; ++lag)
+        {
+            if (coarse[lag] <= 0.0f || coarse[lag] < coarse[lag - 1] || coarse[lag] <= coarse[lag + 1])
+                continue;
+            int slot;
+            if (count < TARGET_CANDIDATES)
+                slot = count++;
+            else if (coarse[lag] > coarse[candidates[TARGET_CANDIDATES - 1]])
+                slot = TARGET_CANDIDATES - 1;
+            else
+                continue;
+
+            // Keep the candidates sorted, strongest first
+            candidates[slot] = lag;
+            for (; slot > 0 && coarse[candidates[slot]] > coarse[candidates[slot - 1]]; --slot)
+                std::swap(candidates[slot], candidates[slot - 1]);
+        }
+
+        // Fine pass: full-rate correlation in a +-factor neighbourhood of each coarse peak
+        for (int c = 0; c < count; ++c)
+        {
+            int lag = refineLag(size, candidates[c] * factor - factor, candidates[c] * factor + factor, minLag, maxLag, energy);
+            if (correlation[lag] > maxCorr)
+            {
+                maxCorr = correlation[lag];
+                bestLag = lag;
+            }
+        }
+    }
+
+    // No valid lag found
+    if (bestLag <= 0)
+        return result;
+
+    // Refine the lag with a parabola through its neighbours, as in chromatic mode;
+    // sampleRate / bestLag alone is several cents off at guitar pitches
+    computeCorrelationDirect(windowed.data(), size, bestLag - 1, bestLag + 1);
+    float period = bestLag + parabolicOffset(normalizedCorrelation(bestLag - 1, correlation[bestLag - 1], energy),
+                                             normalizedCorrelation(bestLag, correlation[bestLag], energy),
+                                             normalizedCorrelation(bestLag + 1, correlation[bestLag + 1], energy));
+    float freq = sampleRate / period;
+
+    // Fold down harmonics
+    float bestFreq = freq;
+    float bestDiff = std::abs(freq - targetFreq);
+    for (int d = 2; d <= 6; ++d)
+    {
+        float f = freq / d;
+        float diff = std::abs(f - targetFreq);
+        if (diff < bestDiff && f > MIN_DETECT_FREQ)
+        {
+            bestFreq = f;
+            bestDiff = diff;
+        }
+    }
+
+    result.frequency = bestFreq;
+    result.confidence = std::min(1.0f, maxCorr);
+    return result;
+}
+
+// Search the whole MIN_DETECT_FREQ..MAX_DETECT_FREQ range without a target.
+// With the direct method this is done coarse-to-fine: correlate a half-band decimated copy of the
+// frame over every lag, then refine at full rate only around the few best coarse peaks.
+// The FFT method already yields every lag at full rate, so it skips the coarse stage.
+PitchResult AutocorrelationDetector::detectChromatic(int size)
+{
+    PitchResult result;
+    int minLag, maxLag;
+    if (!searchRange(size, minLag, maxLag))
+        return result;
+
+    int candidateCount = 0;
+    if (method == CorrelationMethod::FFT)
+    {
+        computeCorrelationFFT(windowed.data(), size, maxLag + 1);
+        // Saved first: normalizing in place turns correlation[0] into 1
+        float energy = correlation[0];
+        if (energy <= 0.0f)
+            return result;
+        for (int lag = 0; lag <= maxLag + 1; ++lag)
+            correlation[lag] = normalizedCorrelation(lag, correlation[lag], energy);
+        candidateCount = findPeaks(correlation.data(), minLag, maxLag, candidates, MAX_CANDIDATES);
+    }
+    else
+    {
+        // Coarse pass on a half-band decimated copy; the filter removes everything that would alias
+        int factor = decimateFrame(size, minLag);
+        int coarseMin = std::max(1, minLag / factor);
+        int coarseMax = std::min(decimatedSize - 2, maxLag / factor);
+
+        computeCorrelationDirect(decimated.data(), decimatedSize, 0, 0);
+        float energy = correlation[0];
+        if (energy <= 0.0f)
+            return result;
+        computeCorrelationDirect(decimated.data(), decimatedSize, coarseMin - 1, coarseMax + 1);
+        for (int lag = coarseMin - 1; lag <= coarseMax + 1; ++lag)
+            coarse[lag] = normalizedCorrelation(lag * factor, correlation[lag], energy);
+
+        int coarseCount = findPeaks(coarse.data(), coarseMin, coarseMax, candidates, MAX_CANDIDATES);
+
+        // Fine pass: full-rate correlation only in a +-factor neighbourhood of each coarse peak
+        computeCorrelationDirect(windowed.data(), size, 0, 0);
+        energy = correlation[0];
+        for (int c = 0; c < coarseCount; ++c)
+        {
+            int lo = std::max(minLag - 1, candidates[c] * factor - factor);
+            int hi = std::min(maxLag + 1, candidates[c] * factor + factor);
+            computeCorrelationDirect(windowed.data(), size, lo, hi);
+
+            int best = lo + 1;
+            for (int lag = lo; lag <= hi; ++lag)
+            {
+                correlation[lag] = normalizedCorrelation(lag, correlation[lag], energy);
+                if (lag > lo && lag < hi && correlation[lag] > correlation[best])
+                    best = lag;
+            }
+            if (correlation[best] > 0.0f)
+                candidates[candidateCount++] = best;
+        }
+    }
+
+    if (candidateCount == 0)
+        return result;
+
+    // Pick the shortest-lag candidate that is nearly as strong as the strongest one;
+    // longer lags at multiples of the period correlate almost as well and would read an octave low
+    float strongest = 0.0f;
+    for (int c = 0; c < candidateCount; ++c)
+        strongest = std::max(strongest, correlation[candidates[c]]);
+
+    int bestLag = -1;
+    for (int c = 0; c < candidateCount; ++c)
+    {
+        int lag = candidates[c];
+        if (correlation[lag] >= PEAK_THRESHOLD * strongest && (bestLag < 0 || lag < bestLag))
+            bestLag = lag;
+    }
+
+    float period = bestLag + parabolicOffset(correlation[bestLag - 1], correlation[bestLag], correlation[bestLag + 1]);
+    result.frequency = sampleRate / period;
+    result.confidence = std::min(1.0f, correlation[bestLag]);
+    return result;
+}
+
+// Correlation at a lag normalised by frame energy and by the Hann window's own autocorrelation,
+// which removes the taper that otherwise makes every longer lag look weaker (Boersma, 1993)
+float AutocorrelationDetector::normalizedCorrelation(int lag, float value, float energy) const
+{
+    float taper = hannTables[activeTable].correlation[lag];
+    if (taper <= 0.0f || energy <= 0.0f)
+        return 0.0f;
+    return value / (energy * taper);
+}
+
+// Collect the first maxCount local maxima of data in [lo, hi] that reach PEAK_FLOOR.
+// Taking them in lag order (rather than the strongest) keeps the true period ahead of its
+// multiples, which correlate just as well once the window taper is removed.
+int AutocorrelationDetector::findPeaks(const float *data, int lo, int hi, int *out, int maxCount)
+{
+    int count = 0;
+    for (int lag = lo; lag <= hi && count < maxCount; ++lag)
+    {
+        if (data[lag] >= PEAK_FLOOR && data[lag] >= data[lag - 1] && data[lag] > data[lag + 1])
+            out[count++] = lag;
+    }
+    return count;
+}
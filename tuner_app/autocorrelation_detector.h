@@ -0,0 +1,62 @@
+#include "frequency_detector.h"
+#include "decimator.h"
+#pragma once
+
+// Hann-windowed autocorrelation engine: the original tuner algorithm.
+// Target mode picks the strongest lag around the target and folds harmonics back onto it;
+// chromatic mode takes the shortest strong period over the whole range. With the direct method both
+// search a half-band decimated copy of the frame first and refine only the best lags at full rate.
+class AutocorrelationDetector : public FrequencyDetector
+{
+public:
+    AutocorrelationDetector(float sampleRate, int maxFrameSize);
+    PitchEngine getEngine() const override;
+
+protected:
+    void allocate(int maxFrameSize) override;
+    void prepare(int size) override;
+    PitchResult estimate(const float *input, int size) override;
+    bool periodicity(const float *input, int size, int minLag, int maxLag) override;
+
+private:
+    static constexpr int MAX_CANDIDATES = 6;    // chromatic coarse peaks refined at full rate
+    static constexpr int TARGET_CANDIDATES = 2; // target mode coarse peaks refined at full rate
+    static constexpr int MIN_COARSE_LAG = 4;    // shortest period, in decimated samples, the coarse pass may see
+
+    PitchResult detectTarget(int size);
+    PitchResult detectChromatic(int size);
+
+    // Window the input into `windowed`
+    void applyWindow(const float *input, int size);
+
+    // Anti-aliased decimated copy of the windowed frame for the coarse pass; returns the factor used
+    int decimateFrame(int size, int minLag);
+
+    // Full-rate, taper-compensated correlation over [lo, hi] clipped to the search range, left in
+    // correlation[]; returns the strongest lag
+    int refineLag(int size, int lo, int hi, int minLag, int maxLag, float energy);
+
+    // Hann window for one frame size and its normalised autocorrelation, used to undo the taper
+    struct HannTable
+    {
+        int size = 0;
+        std::vector<float> window;
+        std::vector<float> correlation;
+    };
+
+    // Fill a table for the given size (cos() and one FFT); never on the fast path for prepared sizes
+    void buildWindow(HannTable &table, int size);
+
+    float normalizedCorrelation(int lag, float value, float energy) const;
+    static int findPeaks(const float *data, int lo, int hi, int *out, int maxCount);
+
+    // Slot 0 is rebuilt for sizes nobody prepared; the others hold one prepared size each
+    std::vector<HannTable> hannTables;
+    int activeTable = 0;
+    std::vector<float> windowed;
+    HalfBandDecimator decimator;
+    std::vector<float> decimated;
+    int decimatedSize = 0;
+    std::vector<float> coarse;
+    int candidates[MAX_CANDIDATES];
+};
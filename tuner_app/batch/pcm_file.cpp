@@ -0,0 +1,244 @@
+#include "pcm_file.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// WAVE format tags
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path)
+{
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("cannot open " + path);
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    if (length == 0)
+        return;
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        bytes = static_cast<const std::uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // The mapping keeps its own reference to the file
+    void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        throw std::runtime_error("cannot map " + path);
+    madvise(view, length, MADV_SEQUENTIAL);
+    bytes = static_cast<const std::uint8_t *>(view);
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        munmap(const_cast<std::uint8_t *>(bytes), length);
+}
+#endif
+
+const std::uint8_t *MappedFile::data() const
+{
+    return bytes;
+}
+
+std::size_t MappedFile::size() const
+{
+    return length;
+}
+
+// Little-endian field readers; WAV headers are not necessarily aligned
+static std::uint16_t readU16(const std::uint8_t *p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+static std::uint32_t readU32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+static int formatBytes(SampleFormat format)
+{
+    switch (format)
+    {
+    case SampleFormat::Int16:
+        return 2;
+    case SampleFormat::Int24:
+        return 3;
+    case SampleFormat::Int32:
+    case SampleFormat::Float32:
+    default:
+        return 4;
+    }
+}
+
+PcmFile::PcmFile(const std::string &path, int rawSampleRate, SampleFormat rawFormat, int rawChannels)
+    : file(path), sampleRate(rawSampleRate), channels(rawChannels), format(rawFormat)
+{
+    if (file.size() >= 12 && std::memcmp(file.data(), "RIFF", 4) == 0 && std::memcmp(file.data() + 8, "WAVE", 4) == 0)
+    {
+        parseWav();
+        return;
+    }
+
+    bytesPerSample = formatBytes(format);
+    samples = file.data();
+    frames = file.size() / (static_cast<std::size_t>(bytesPerSample) * channels);
+}
+
+void PcmFile::parseWav()
+{
+    const std::uint8_t *p = file.data() + 12;
+    const std::uint8_t *end = file.data() + file.size();
+    bool haveFormat = false;
+
+    while (end - p >= 8)
+    {
+        std::uint32_t chunkSize = readU32(p + 4);
+        const std::uint8_t *body = p + 8;
+        // Recorders that crash mid-take leave the data size too large; use what is there
+        std::size_t available = std::min<std::size_t>(chunkSize, end - body);
+
+        if (std::memcmp(p, "fmt ", 4) == 0 && available >= 16)
+        {
+            int tag = readU16(body);
+            channels = readU16(body + 2);
+            sampleRate = static_cast<int>(readU32(body + 4));
+            int bits = readU16(body + 14);
+            if (tag == WAV_FORMAT_EXTENSIBLE && available >= 26)
+                tag = readU16(body + 24); // first two bytes of the sub-format GUID
+
+            if (tag == WAV_FORMAT_FLOAT && bits == 32)
+                format = SampleFormat::Float32;
+            else if (tag == WAV_FORMAT_PCM && bits == 16)
+                format = SampleFormat::Int16;
+            else if (tag == WAV_FORMAT_PCM && bits == 24)
+                format = SampleFormat::Int24;
+            else if (tag == WAV_FORMAT_PCM && bits == 32)
+                format = SampleFormat::Int32;
+            else
+                throw std::runtime_error("unsupported WAV sample format (tag " + std::to_string(tag) + ", " +
+                                         std::to_string(bits) + " bits)");
+            if (channels < 1 || sampleRate < 1)
+                throw std::runtime_error("invalid WAV format chunk");
+            haveFormat = true;
+        }
+        else if (std::memcmp(p, "data", 4) == 0)
+        {
+            if (!haveFormat)
+                throw std::runtime_error("WAV data chunk before format chunk");
+            bytesPerSample = formatBytes(format);
+            samples = body;
+            frames = available / (static_cast<std::size_t>(bytesPerSample) * channels);
+            return;
+        }
+
+        // Chunks are padded to an even length
+        std::size_t skip = 8 + static_cast<std::size_t>(chunkSize) + (chunkSize & 1);
+        if (skip > static_cast<std::size_t>(end - p))
+            break;
+        p += skip;
+    }
+    throw std::runtime_error("WAV file has no data chunk");
+}
+
+int PcmFile::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int PcmFile::getChannels() const
+{
+    return channels;
+}
+
+std::size_t PcmFile::getFrames() const
+{
+    return frames;
+}
+
+void PcmFile::read(std::size_t first, int count, int channel, float *out) const
+{
+    const std::size_t stride = static_cast<std::size_t>(bytesPerSample) * channels;
+    const std::uint8_t *p = samples + first * stride + static_cast<std::size_t>(channel) * bytesPerSample;
+
+    switch (format)
+    {
+    case SampleFormat::Int16:
+        for (int i = 0; i < count; ++i, p += stride)
+            out[i] = static_cast<std::int16_t>(readU16(p)) * (1.0f / 32768.0f);
+        break;
+    case SampleFormat::Int24:
+        for (int i = 0; i < count; ++i, p += stride)
+        {
+            // Place the 24 bits at the top of an int32 so the sign comes along
+            std::int32_t v = static_cast<std::int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<std::uint32_t>(p[2]) << 24));
+            out[i] = v * (1.0f / 2147483648.0f);
+        }
+        break;
+    case SampleFormat::Int32:
+        for (int i = 0; i < count; ++i, p += stride)
+            out[i] = static_cast<std::int32_t>(readU32(p)) * (1.0f / 2147483648.0f);
+        break;
+    case SampleFormat::Float32:
+    default:
+        for (int i = 0; i < count; ++i, p += stride)
+        {
+            std::uint32_t bits = readU32(p);
+            std::memcpy(&out[i], &bits, sizeof(float));
+        }
+        break;
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#pragma once
+
+// Sample encodings the batch tools can read
+enum class SampleFormat
+{
+    Int16,
+    Int24,
+    Int32,
+    Float32
+};
+
+// Read-only memory mapping of a whole file; the pages are loaded on demand by the OS, so
+// streaming through a large file never copies it into the heap. Throws std::runtime_error.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::uint8_t *data() const;
+    std::size_t size() const;
+
+private:
+    const std::uint8_t *bytes = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void *file = nullptr;
+    void *mapping = nullptr;
+#endif
+};
+
+// Interleaved PCM samples inside a mapped file: a WAV file's data chunk or a headerless raw file
+class PcmFile
+{
+public:
+    // WAV files are recognized by their RIFF header; anything else is taken as raw PCM with the given
+    // layout. Throws std::runtime_error for malformed or unsupported WAV files.
+    PcmFile(const std::string &path, int rawSampleRate, SampleFormat rawFormat, int rawChannels = 1);
+
+    int getSampleRate() const;
+    int getChannels() const;
+    std::size_t getFrames() const;
+
+    // Convert count frames of one channel, starting at frame first, to floats in [-1, 1)
+    void read(std::size_t first, int count, int channel, float *out) const;
+
+private:
+    void parseWav();
+
+    MappedFile file;
+    const std::uint8_t *samples = nullptr;
+    std::size_t frames = 0;
+    int sampleRate;
+    int channels;
+    SampleFormat format;
+    int bytesPerSample = 0;
+};
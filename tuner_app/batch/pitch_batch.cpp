@@ -0,0 +1,400 @@
+// Offline pitch analysis of recorded files, e.g. to check detector accuracy and cost on a corpus of
+// plucks without audio hardware. Files are memory-mapped and streamed hop by hop through the same
+// StreamingAnalyzer/FrequencyDetector path as the live tuner, several files at once on a pool of
+// worker threads. Each input gets a per-frame output file next to it (or in --output), and the run
+// ends with the aggregate throughput in samples per second.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -pthread -I. batch/pitch_batch.cpp batch/pcm_file.cpp streaming_analyzer.cpp
+//       strobe_tracker.cpp frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp
+//       mcleod_detector.cpp goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp onset_detector.cpp
+//       -o pitch_batch
+#include "pcm_file.h"
+#include "frequency_detector.h"
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_WINDOW_SIZE 2048
+#define DEFAULT_HOP_SIZE 256
+#define DEFAULT_SILENCE_RMS 0.01f
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+// Binary output: the 16-byte BinaryHeader, then one BinaryFrame per analysis, native little-endian
+#define BINARY_MAGIC "PTCH"
+#define BINARY_VERSION 1
+
+struct BinaryHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t sampleRate;
+    std::uint32_t hopSize;
+};
+
+struct BinaryFrame
+{
+    std::uint32_t endSample; // stream position just past the analyzed window
+    float frequency;         // Hz, 0 when no pitch was found or the window was silent
+    float confidence;
+    float rms;
+};
+
+enum class OutputFormat
+{
+    CSV,
+    Binary
+};
+
+struct BatchOptions
+{
+    PitchEngine engine = PitchEngine::McLeod;
+    CorrelationMethod method = CorrelationMethod::FFT;
+    int windowSize = DEFAULT_WINDOW_SIZE;
+    int hopSize = DEFAULT_HOP_SIZE;
+    float targetFreq = 0.0f; // 0: chromatic
+    float silence = DEFAULT_SILENCE_RMS;
+    int channel = 0;
+    int jobs = 0;
+    OutputFormat format = OutputFormat::CSV;
+    std::string outputDir; // empty: next to the input
+    int rawSampleRate = 48000;
+    SampleFormat rawFormat = SampleFormat::Float32;
+    int rawChannels = 1;
+    std::vector<std::string> files;
+};
+
+// Outcome of one input file
+struct FileReport
+{
+    std::string error;
+    double seconds = 0.0;        // audio duration
+    std::uint64_t samples = 0;
+    std::uint64_t frames = 0;    // analyses written
+    std::uint64_t voiced = 0;    // analyses that found a pitch
+    double busyMillis = 0.0;     // wall time spent on the file by its worker
+};
+
+static void usage()
+{
+    std::fprintf(stderr,
+                 "Usage: pitch_batch [options] file...\n"
+                 "  -e, --engine autocorrelation|yin|mcleod   pitch engine (mcleod)\n"
+                 "  -m, --method direct|fft                   correlation method (fft)\n"
+                 "  -w, --window N                            analysis window in samples (%d)\n"
+                 "  -H, --hop N                               samples between analyses (%d)\n"
+                 "  -t, --target HZ                           target mode around HZ instead of chromatic\n"
+                 "  -s, --silence RMS                         skip windows quieter than RMS (%g)\n"
+                 "  -c, --channel N                           channel of multi-channel files, 0-based (0)\n"
+                 "  -j, --jobs N                              files analyzed in parallel (one per core)\n"
+                 "  -f, --format csv|binary                   per-frame output format (csv)\n"
+                 "  -o, --output DIR                          write outputs to DIR instead of next to the inputs\n"
+                 "      --raw-rate HZ                         sample rate of headerless files (48000)\n"
+                 "      --raw-format s16|s24|s32|f32          sample format of headerless files (f32)\n"
+                 "      --raw-channels N                      channel count of headerless files (1)\n",
+                 DEFAULT_WINDOW_SIZE, DEFAULT_HOP_SIZE, DEFAULT_SILENCE_RMS);
+}
+
+static bool parseOptions(int argc, char *argv[], BatchOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.empty() || arg[0] != '-')
+        {
+            options.files.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-e" || arg == "--engine")
+        {
+            if (value == "autocorrelation")
+                options.engine = PitchEngine::Autocorrelation;
+            else if (value == "yin")
+                options.engine = PitchEngine::YIN;
+            else if (value == "mcleod")
+                options.engine = PitchEngine::McLeod;
+            else
+                return false;
+        }
+        else if (arg == "-m" || arg == "--method")
+        {
+            if (value == "direct")
+                options.method = CorrelationMethod::Direct;
+            else if (value == "fft")
+                options.method = CorrelationMethod::FFT;
+            else
+                return false;
+        }
+        else if (arg == "-w" || arg == "--window")
+            options.windowSize = std::atoi(value.c_str());
+        else if (arg == "-H" || arg == "--hop")
+            options.hopSize = std::atoi(value.c_str());
+        else if (arg == "-t" || arg == "--target")
+            options.targetFreq = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "-s" || arg == "--silence")
+            options.silence = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "-c" || arg == "--channel")
+            options.channel = std::atoi(value.c_str());
+        else if (arg == "-j" || arg == "--jobs")
+            options.jobs = std::atoi(value.c_str());
+        else if (arg == "-f" || arg == "--format")
+        {
+            if (value == "csv")
+                options.format = OutputFormat::CSV;
+            else if (value == "binary")
+                options.format = OutputFormat::Binary;
+            else
+                return false;
+        }
+        else if (arg == "-o" || arg == "--output")
+            options.outputDir = value;
+        else if (arg == "--raw-rate")
+            options.rawSampleRate = std::atoi(value.c_str());
+        else if (arg == "--raw-format")
+        {
+            if (value == "s16")
+                options.rawFormat = SampleFormat::Int16;
+            else if (value == "s24")
+                options.rawFormat = SampleFormat::Int24;
+            else if (value == "s32")
+                options.rawFormat = SampleFormat::Int32;
+            else if (value == "f32")
+                options.rawFormat = SampleFormat::Float32;
+            else
+                return false;
+        }
+        else if (arg == "--raw-channels")
+            options.rawChannels = std::atoi(value.c_str());
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (options.windowSize < 64 || options.hopSize < 1 || options.hopSize > options.windowSize)
+    {
+        std::fprintf(stderr, "The window must be at least 64 samples and the hop 1..window\n");
+        return false;
+    }
+    if (options.rawSampleRate < 1 || options.rawChannels < 1 || options.channel < 0)
+        return false;
+    return !options.files.empty();
+}
+
+static std::string outputPath(const BatchOptions &options, const std::string &input)
+{
+    std::string path = input;
+    if (!options.outputDir.empty())
+    {
+        std::size_t slash = input.find_last_of("/\\");
+        path = options.outputDir + "/" + (slash == std::string::npos ? input : input.substr(slash + 1));
+    }
+    return path + (options.format == OutputFormat::CSV ? ".pitch.csv" : ".pitch.bin");
+}
+
+// Analysis state of one worker thread, reused from file to file
+class BatchWorker
+{
+public:
+    explicit BatchWorker(const BatchOptions &options)
+        : options(options), analyzer(options.windowSize, options.hopSize), hop(options.hopSize),
+          outputBuffer(OUTPUT_BUFFER_SIZE)
+    {
+        analyzer.setSilenceThreshold(options.silence);
+    }
+
+    FileReport process(const std::string &path, const std::string &target)
+    {
+        FileReport report;
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            analyzeFile(path, target, report);
+        }
+        catch (const std::exception &e)
+        {
+            report.error = e.what();
+        }
+        report.busyMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+private:
+    void analyzeFile(const std::string &path, const std::string &target, FileReport &report)
+    {
+        PcmFile pcm(path, options.rawSampleRate, options.rawFormat, options.rawChannels);
+        if (options.channel >= pcm.getChannels())
+            throw std::runtime_error("file has only " + std::to_string(pcm.getChannels()) + " channel(s)");
+        prepareDetector(static_cast<float>(pcm.getSampleRate()));
+
+        std::unique_ptr<FILE, int (*)(FILE *)> out(std::fopen(target.c_str(), options.format == OutputFormat::CSV ? "w" : "wb"), &std::fclose);
+        if (!out)
+            throw std::runtime_error("cannot write " + target);
+        std::setvbuf(out.get(), outputBuffer.data(), _IOFBF, outputBuffer.size());
+
+        // double: a float holds whole samples only up to 2^24, about 6 minutes at 48 kHz
+        const double sampleRate = pcm.getSampleRate();
+        if (options.format == OutputFormat::CSV)
+        {
+            std::fputs("time_s,end_sample,frequency_hz,confidence,rms\n", out.get());
+        }
+        else
+        {
+            BinaryHeader header;
+            std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+            header.version = BINARY_VERSION;
+            header.sampleRate = static_cast<std::uint32_t>(pcm.getSampleRate());
+            header.hopSize = static_cast<std::uint32_t>(hop.size());
+            std::fwrite(&header, sizeof(header), 1, out.get());
+        }
+
+        // Hop-sized pushes give exactly one analysis per hop once the window has filled
+        analyzer.reset();
+        const std::size_t frames = pcm.getFrames();
+        for (std::size_t first = 0; first < frames; first += hop.size())
+        {
+            int count = static_cast<int>(std::min<std::size_t>(hop.size(), frames - first));
+            pcm.read(first, count, options.channel, hop.data());
+            if (analyzer.push(hop.data(), count) == 0)
+                continue;
+
+            const StreamReading &reading = analyzer.latest();
+            ++report.frames;
+            if (reading.pitch.frequency > 0.0f)
+                ++report.voiced;
+
+            if (options.format == OutputFormat::CSV)
+            {
+                std::fprintf(out.get(), "%.6f,%lld,%.4f,%.4f,%.5f\n", reading.endSample / sampleRate,
+                             reading.endSample, reading.pitch.frequency, reading.pitch.confidence, reading.rms);
+            }
+            else
+            {
+                BinaryFrame frame = {static_cast<std::uint32_t>(reading.endSample), reading.pitch.frequency,
+                                     reading.pitch.confidence, reading.rms};
+                std::fwrite(&frame, sizeof(frame), 1, out.get());
+            }
+        }
+
+        if (std::ferror(out.get()))
+            throw std::runtime_error("write error on " + target);
+        report.samples = frames;
+        report.seconds = frames / sampleRate;
+    }
+
+    // Detectors are sized for one sample rate; files at another rate get a fresh one
+    void prepareDetector(float sampleRate)
+    {
+        if (detector && detectorRate == sampleRate)
+            return;
+        detector = FrequencyDetector::create(options.engine, sampleRate, options.windowSize);
+        detector->setCorrelationMethod(options.method);
+        if (options.targetFreq > 0.0f)
+            detector->setTarget(options.targetFreq);
+        else
+            detector->setChromatic();
+        detectorRate = sampleRate;
+        analyzer.setDetector(detector.get());
+    }
+
+    const BatchOptions &options;
+    StreamingAnalyzer analyzer;
+    std::unique_ptr<FrequencyDetector> detector;
+    float detectorRate = 0.0f;
+    std::vector<float> hop;
+    std::vector<char> outputBuffer;
+};
+
+int main(int argc, char *argv[])
+{
+    BatchOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        usage();
+        return 2;
+    }
+
+    int jobs = options.jobs > 0 ? options.jobs : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    jobs = std::min(jobs, static_cast<int>(options.files.size()));
+
+    // Workers pull the next file as they finish one, so long and short files balance out
+    std::vector<FileReport> reports(options.files.size());
+
+    // Inputs that would write the same output, e.g. equal names from different directories with -o,
+    // fail instead of overwriting each other
+    std::vector<std::string> targets(options.files.size());
+    std::map<std::string, std::size_t> owners;
+    for (std::size_t f = 0; f < options.files.size(); ++f)
+    {
+        targets[f] = outputPath(options, options.files[f]);
+        auto owner = owners.emplace(targets[f], f);
+        if (!owner.second)
+            reports[f].error = "output " + targets[f] + " is already written for " + options.files[owner.first->second];
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int j = 0; j < jobs; ++j)
+    {
+        workers.emplace_back([&]()
+                             {
+            BatchWorker worker(options);
+            std::size_t index;
+            while ((index = next.fetch_add(1)) < options.files.size())
+            {
+                if (reports[index].error.empty())
+                    reports[index] = worker.process(options.files[index], targets[index]);
+            } });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t samples = 0, frames = 0, voiced = 0;
+    double audioSeconds = 0.0, busySeconds = 0.0;
+    int failed = 0;
+    for (std::size_t f = 0; f < reports.size(); ++f)
+    {
+        const FileReport &report = reports[f];
+        if (!report.error.empty())
+        {
+            std::fprintf(stderr, "%s: %s\n", options.files[f].c_str(), report.error.c_str());
+            ++failed;
+            continue;
+        }
+        std::printf("%s: %.2f s, %llu frames (%llu voiced), %.1f ms\n", options.files[f].c_str(), report.seconds,
+                    static_cast<unsigned long long>(report.frames), static_cast<unsigned long long>(report.voiced),
+                    report.busyMillis);
+        samples += report.samples;
+        frames += report.frames;
+        voiced += report.voiced;
+        audioSeconds += report.seconds;
+        busySeconds += report.busyMillis / 1000.0;
+    }
+
+    std::printf("%zu files (%d failed), %.1f s of audio, %llu frames (%llu voiced) in %.3f s on %d workers\n",
+                reports.size(), failed, audioSeconds, static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(voiced), wallSeconds, jobs);
+    std::printf("Throughput: %.0f samples/s (%.0f samples/s per worker, %.0fx real time)\n", samples / wallSeconds,
+                busySeconds > 0.0 ? samples / busySeconds : 0.0, audioSeconds / wallSeconds);
+    return failed > 0 ? 1 : 0;
+}
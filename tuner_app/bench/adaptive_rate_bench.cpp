@@ -0,0 +1,134 @@
+// Cost of the adaptive analysis rate against analyzing every hop. A 7 s clip (1 s silence, 3 s of
+// steady A2, a 30-cent glide over 1 s, 1 s steady at the top, 1 s silence) runs through
+// StreamingAnalyzer in target mode at A2, for the engine/method pairs below, with the adaptive rate
+// off and on. Prints the analyses run, the best of REPEATS times spent in push(), and the worst
+// error of the displayed (latest) reading against the true pitch at every hop from the start of the
+// glide to the end of the tone.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/adaptive_rate_bench.cpp streaming_analyzer.cpp strobe_tracker.cpp
+//       frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp mcleod_detector.cpp
+//       goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp onset_detector.cpp -o adaptive_rate_bench
+#include "frequency_detector.h"
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define WINDOW_SIZE 2048
+#define HOP_SIZE 256
+#define SILENCE_RMS 0.01f
+#define SIGNAL_LEVEL 0.3f
+#define TONE_HZ 110.0
+#define GLIDE_CENTS 30.0
+#define REPEATS 5
+
+// Clip sections, in seconds from the start
+#define TONE_START 1.0
+#define GLIDE_START 4.0
+#define GLIDE_END 5.0
+#define TONE_END 6.0
+#define CLIP_END 7.0
+
+static double truePitch(double t)
+{
+    double cents = t < GLIDE_START ? 0.0 : t < GLIDE_END ? GLIDE_CENTS * (t - GLIDE_START) / (GLIDE_END - GLIDE_START) : GLIDE_CENTS;
+    return TONE_HZ * std::pow(2.0, cents / 1200.0);
+}
+
+// Phase-continuous tone with a few harmonics, so the glide has no clicks
+static std::vector<float> makeClip()
+{
+    static const double amplitudes[] = {1.0, 0.5, 0.3, 0.2};
+    std::vector<float> clip(static_cast<std::size_t>(CLIP_END * SAMPLE_RATE), 0.0f);
+    double phase = 0.0;
+    for (std::size_t i = 0; i < clip.size(); ++i)
+    {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        if (t < TONE_START || t >= TONE_END)
+            continue;
+        double v = 0.0;
+        for (int h = 0; h < 4; ++h)
+            v += amplitudes[h] * std::sin((h + 1) * phase);
+        clip[i] = static_cast<float>(SIGNAL_LEVEL / 2.0 * v);
+        phase += 6.283185307179586 * truePitch(t) / SAMPLE_RATE;
+    }
+    return clip;
+}
+
+struct RunResult
+{
+    long long analyses = 0;
+    double millis = 0.0;
+    double worstCents = 0.0;
+};
+
+static RunResult run(PitchEngine engine, CorrelationMethod method, bool adaptive, const std::vector<float> &clip)
+{
+    std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, WINDOW_SIZE);
+    detector->setCorrelationMethod(method);
+    detector->setTarget(static_cast<float>(TONE_HZ));
+    StreamingAnalyzer analyzer(WINDOW_SIZE, HOP_SIZE);
+    analyzer.setDetector(detector.get());
+    analyzer.setSilenceThreshold(SILENCE_RMS);
+    analyzer.setAdaptive(adaptive);
+
+    RunResult result;
+    result.millis = 1e30;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        analyzer.reset();
+        analyzer.setAdaptive(adaptive);
+        long long analyses = 0;
+        double worst = 0.0;
+        double nanos = 0.0;
+        for (std::size_t first = 0; first + HOP_SIZE <= clip.size(); first += HOP_SIZE)
+        {
+            auto start = std::chrono::steady_clock::now();
+            analyses += analyzer.push(clip.data() + first, HOP_SIZE);
+            nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            double t = static_cast<double>(first + HOP_SIZE) / SAMPLE_RATE;
+            float shown = analyzer.latest().pitch.frequency;
+            if (t >= GLIDE_START && t < TONE_END)
+            {
+                double cents = shown > 0.0f ? std::fabs(1200.0 * std::log2(shown / truePitch(t))) : 1200.0;
+                worst = std::max(worst, cents);
+            }
+        }
+        result.analyses = analyses;
+        result.worstCents = worst;
+        result.millis = std::min(result.millis, nanos * 1e-6);
+    }
+    return result;
+}
+
+int main()
+{
+    struct Variant
+    {
+        PitchEngine engine;
+        CorrelationMethod method;
+        const char *name;
+    };
+    const Variant variants[] = {{PitchEngine::YIN, CorrelationMethod::Direct, "YIN Direct"},
+                                {PitchEngine::McLeod, CorrelationMethod::Direct, "McLeod Direct"},
+                                {PitchEngine::McLeod, CorrelationMethod::FFT, "McLeod FFT"},
+                                {PitchEngine::Autocorrelation, CorrelationMethod::FFT, "Autocorr FFT"}};
+
+    std::vector<float> clip = makeClip();
+    std::printf("%-14s %21s %21s %21s\n", "", "analyses", "push time (ms)", "worst glide cents");
+    std::printf("%-14s %10s %10s %10s %10s %10s %10s\n", "engine", "every hop", "adaptive", "every hop", "adaptive",
+                "every hop", "adaptive");
+    for (const Variant &variant : variants)
+    {
+        RunResult fixed = run(variant.engine, variant.method, false, clip);
+        RunResult adaptive = run(variant.engine, variant.method, true, clip);
+        std::printf("%-14s %10lld %10lld %10.1f %10.1f %10.2f %10.2f\n", variant.name, fixed.analyses, adaptive.analyses,
+                    fixed.millis, adaptive.millis, fixed.worstCents, adaptive.worstCents);
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include <cstddef>
+#include <random>
+#include <vector>
+#pragma once
+
+// Test signals shared by the benches in this directory
+
+// Karplus-Strong pluck added onto out from sample `start` to the end. The noise burst is uniform in
+// [-level, level] and the loop loses `decay` per period; a first-order allpass takes the fractional
+// part of the loop delay (N + 0.5 for the two-point average + allpass), so the pitch is exact to well
+// under a cent.
+inline void addPluck(std::vector<float> &out, std::size_t start, float freq, float sampleRate, float level, float decay,
+                     std::mt19937 &rng)
+{
+    float loop = sampleRate / freq - 0.5f;
+    int length = static_cast<int>(loop - 0.1f);
+    float fraction = loop - length;
+    float coefficient = (1.0f - fraction) / (1.0f + fraction);
+
+    std::uniform_real_distribution<float> dist(-level, level);
+    std::vector<float> line(length);
+    for (float &s : line)
+        s = dist(rng);
+
+    float previous = 0.0f, allpassIn = 0.0f, allpassOut = 0.0f;
+    for (std::size_t i = 0; start + i < out.size(); ++i)
+    {
+        float current = line[i % length];
+        float averaged = decay * 0.5f * (current + previous);
+        previous = current;
+        allpassOut = coefficient * averaged + allpassIn - coefficient * allpassOut;
+        allpassIn = averaged;
+        line[i % length] = allpassOut;
+        out[start + i] += current;
+    }
+}
@@ -0,0 +1,290 @@
+// Accuracy and cost benchmark for the pitch engines on deterministic synthetic signals: Karplus-Strong
+// plucks and harmonics-heavy tones, clean and with white noise at several SNRs, detuned around every
+// string of standard tuning. Each engine and window size is run through StreamingAnalyzer in chromatic
+// mode and in target mode (aimed at the string) and scored on cents error, octave-error rate, time to
+// the first stable reading and ns per analyzed sample. A level sweep then runs a two-partial tone on
+// every string, from LEVELS[0] down to just above the silence gate, through both correlation methods
+// in chromatic mode: detection and confidence must not depend on the input level. Results are
+// printed as JSON on stdout, progress on stderr.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/detector_bench.cpp streaming_analyzer.cpp strobe_tracker.cpp
+//       frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp mcleod_detector.cpp
+//       goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp onset_detector.cpp -o detector_bench
+#include "bench_signals.h"
+#include "frequency_detector.h"
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define HOP_SIZE 256
+#define SIGNAL_SECONDS 1.0f
+#define SIGNAL_LEVEL 0.3f // peak-ish level of the clean signal, like a DI guitar
+#define SILENCE_RMS 0.01f
+
+// A reading is an octave error when it is nearer another octave of the truth than the truth itself
+#define OCTAVE_ERROR_CENTS 600.0f
+// Stable: this many consecutive readings within STABLE_CENTS of the truth
+#define STABLE_CENTS 5.0f
+#define STABLE_READINGS 3
+
+enum class SignalKind
+{
+    Pluck,    // Karplus-Strong string, decaying, inharmonicity-free
+    Harmonic  // steady tone with a weak fundamental and strong upper harmonics
+};
+
+static const char *signalName(SignalKind kind)
+{
+    return kind == SignalKind::Pluck ? "pluck" : "harmonic";
+}
+
+static void harmonic(float freq, std::mt19937 &rng, std::vector<float> &out)
+{
+    // Weak fundamental, as on a bridge pickup; random but fixed phases per case
+    static const float amplitudes[] = {0.25f, 1.0f, 0.8f, 0.7f, 0.5f, 0.45f, 0.3f, 0.2f};
+    std::uniform_real_distribution<float> phaseDist(0.0f, 6.2831853f);
+    float phases[8];
+    for (float &p : phases)
+        p = phaseDist(rng);
+
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        double v = 0.0;
+        for (int h = 0; h < 8; ++h)
+            v += amplitudes[h] * std::sin(6.283185307179586 * freq * (h + 1) * t + phases[h]);
+        out[i] = static_cast<float>(v);
+    }
+}
+
+// Scale to SIGNAL_LEVEL peak, then add white noise snrDb below the signal's RMS (no noise if snrDb <= 0)
+static void finish(std::vector<float> &signal, float snrDb, std::mt19937 &rng)
+{
+    float peak = 0.0f;
+    for (float s : signal)
+        peak = std::max(peak, std::fabs(s));
+    double energy = 0.0;
+    for (float &s : signal)
+    {
+        s *= SIGNAL_LEVEL / peak;
+        energy += static_cast<double>(s) * s;
+    }
+    if (snrDb <= 0.0f)
+        return;
+
+    float noiseRms = static_cast<float>(std::sqrt(energy / signal.size()) * std::pow(10.0, -snrDb / 20.0));
+    std::normal_distribution<float> noise(0.0f, noiseRms);
+    for (float &s : signal)
+        s += noise(rng);
+}
+
+// Scores of one engine/window/signal/SNR cell, summed over strings and detunings
+struct CellScore
+{
+    int cases = 0;
+    int stableCases = 0;
+    long long analyses = 0;
+    long long readings = 0;       // voiced readings
+    double confidenceSum = 0.0;   // over the voiced readings
+    long long octaveErrors = 0;
+    double centsSum = 0.0;        // |error| of the readings that are not octave errors
+    double centsMax = 0.0;
+    long long centsCount = 0;
+    double stableMillisSum = 0.0; // audio time from the start to the first stable reading
+    double nanos = 0.0;           // time spent in StreamingAnalyzer::push
+    long long samples = 0;
+};
+
+static void runCase(StreamingAnalyzer &analyzer, const std::vector<float> &signal, float truth, CellScore &score)
+{
+    analyzer.reset();
+    int streak = 0;
+    bool stable = false;
+    ++score.cases;
+
+    for (std::size_t first = 0; first + HOP_SIZE <= signal.size(); first += HOP_SIZE)
+    {
+        auto start = std::chrono::steady_clock::now();
+        int analyses = analyzer.push(signal.data() + first, HOP_SIZE);
+        score.nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        score.samples += HOP_SIZE;
+        if (analyses == 0)
+            continue;
+        ++score.analyses;
+
+        const StreamReading &reading = analyzer.latest();
+        if (reading.pitch.frequency <= 0.0f)
+        {
+            streak = 0;
+            continue;
+        }
+
+        ++score.readings;
+        score.confidenceSum += reading.pitch.confidence;
+        float cents = 1200.0f * std::log2(reading.pitch.frequency / truth);
+        if (std::fabs(cents) > OCTAVE_ERROR_CENTS)
+        {
+            ++score.octaveErrors;
+            streak = 0;
+            continue;
+        }
+        score.centsSum += std::fabs(cents);
+        score.centsMax = std::max(score.centsMax, static_cast<double>(std::fabs(cents)));
+        ++score.centsCount;
+
+        streak = std::fabs(cents) <= STABLE_CENTS ? streak + 1 : 0;
+        if (!stable && streak == STABLE_READINGS)
+        {
+            stable = true;
+            ++score.stableCases;
+            score.stableMillisSum += 1000.0 * (first + HOP_SIZE) / SAMPLE_RATE;
+        }
+    }
+}
+
+// Fundamental and octave at the same amplitude, like the plain string of a clean DI guitar
+static void twoPartial(float freq, float amplitude, std::vector<float> &out)
+{
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        out[i] = static_cast<float>(amplitude * (std::sin(6.283185307179586 * freq * t) +
+                                                 std::sin(6.283185307179586 * 2.0 * freq * t)));
+    }
+}
+
+// Amplitudes of each partial; the last has an RMS of about 0.015, just above SILENCE_RMS
+static const float LEVELS[] = {1.0f, 0.3f, 0.1f, 0.03f, 0.015f};
+
+static void levelSweep(const float *strings, int stringCount, std::vector<float> &signal)
+{
+    const PitchEngine engines[] = {PitchEngine::Autocorrelation, PitchEngine::YIN, PitchEngine::McLeod};
+    const CorrelationMethod methods[] = {CorrelationMethod::Direct, CorrelationMethod::FFT};
+    const int window = 2048;
+
+    std::printf("\n  ],\n  \"level_sweep\": [");
+    bool firstResult = true;
+    for (PitchEngine engine : engines)
+    {
+        for (CorrelationMethod method : methods)
+        {
+            std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, window);
+            detector->setCorrelationMethod(method);
+            detector->setChromatic();
+            StreamingAnalyzer analyzer(window, HOP_SIZE);
+            analyzer.setDetector(detector.get());
+            analyzer.setSilenceThreshold(SILENCE_RMS);
+            std::fprintf(stderr, "%s, %s, level sweep\n", FrequencyDetector::engineName(engine),
+                         method == CorrelationMethod::FFT ? "FFT" : "direct");
+
+            for (float level : LEVELS)
+            {
+                CellScore score;
+                for (int s = 0; s < stringCount; ++s)
+                {
+                    twoPartial(strings[s], level, signal);
+                    runCase(analyzer, signal, strings[s], score);
+                }
+                std::printf("%s\n    {\"engine\": \"%s\", \"method\": \"%s\", \"level\": %.3f, \"analyses\": %lld, "
+                            "\"voiced_rate\": %.4f, \"mean_abs_cents\": %.4f, \"octave_error_rate\": %.4f, "
+                            "\"mean_confidence\": %.4f}",
+                            firstResult ? "" : ",", FrequencyDetector::engineName(engine),
+                            method == CorrelationMethod::FFT ? "fft" : "direct", level, score.analyses,
+                            score.analyses ? static_cast<double>(score.readings) / score.analyses : 0.0,
+                            score.centsCount ? score.centsSum / score.centsCount : 0.0,
+                            score.readings ? static_cast<double>(score.octaveErrors) / score.readings : 0.0,
+                            score.readings ? score.confidenceSum / score.readings : 0.0);
+                firstResult = false;
+            }
+        }
+    }
+}
+
+int main()
+{
+    const PitchEngine engines[] = {PitchEngine::Autocorrelation, PitchEngine::YIN, PitchEngine::McLeod};
+    const int windows[] = {1024, 2048, 4096};
+    const SignalKind kinds[] = {SignalKind::Pluck, SignalKind::Harmonic};
+    const float snrs[] = {0.0f, 40.0f, 20.0f, 10.0f}; // 0: clean
+    const float strings[] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f};
+    const float detunings[] = {-23.0f, 0.0f, 7.5f};
+    const bool targetModes[] = {false, true};
+
+    std::vector<float> signal(static_cast<std::size_t>(SIGNAL_SECONDS * SAMPLE_RATE));
+    std::printf("{\n  \"sample_rate\": %d,\n  \"hop\": %d,\n  \"signal_seconds\": %.2f,\n  \"results\": [", SAMPLE_RATE,
+                HOP_SIZE, SIGNAL_SECONDS);
+    bool firstResult = true;
+
+    for (PitchEngine engine : engines)
+    {
+        for (int window : windows)
+        {
+            for (bool target : targetModes)
+            {
+                std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, window);
+                detector->setCorrelationMethod(CorrelationMethod::FFT);
+                detector->setChromatic();
+                StreamingAnalyzer analyzer(window, HOP_SIZE);
+                analyzer.setDetector(detector.get());
+                analyzer.setSilenceThreshold(SILENCE_RMS);
+                std::fprintf(stderr, "%s, window %d, %s\n", FrequencyDetector::engineName(engine), window,
+                             target ? "target" : "chromatic");
+
+                for (SignalKind kind : kinds)
+                {
+                    for (float snr : snrs)
+                    {
+                        // Same seed for every engine and window, so they all see identical signals
+                        std::mt19937 rng(1234);
+                        CellScore score;
+                        for (float string : strings)
+                        {
+                            for (float detune : detunings)
+                            {
+                                float truth = string * std::pow(2.0f, detune / 1200.0f);
+                                if (kind == SignalKind::Pluck)
+                                {
+                                    std::fill(signal.begin(), signal.end(), 0.0f);
+                                    addPluck(signal, 0, truth, SAMPLE_RATE, 1.0f, 0.996f, rng);
+                                }
+                                else
+                                    harmonic(truth, rng, signal);
+                                finish(signal, snr, rng);
+                                if (target)
+                                    detector->setTarget(string);
+                                runCase(analyzer, signal, truth, score);
+                            }
+                        }
+
+                        std::printf("%s\n    {\"engine\": \"%s\", \"window\": %d, \"mode\": \"%s\", \"signal\": \"%s\", "
+                                    "\"snr_db\": ",
+                                    firstResult ? "" : ",", FrequencyDetector::engineName(engine), window,
+                                    target ? "target" : "chromatic", signalName(kind));
+                        if (snr > 0.0f)
+                            std::printf("%.0f", snr);
+                        else
+                            std::printf("null");
+                        std::printf(", \"cases\": %d, \"readings\": %lld, \"mean_abs_cents\": %.4f, \"max_abs_cents\": %.4f, "
+                                    "\"octave_error_rate\": %.4f, \"stable_cases\": %d, \"mean_time_to_stable_ms\": %.2f, "
+                                    "\"ns_per_sample\": %.2f}",
+                                    score.cases, score.readings,
+                                    score.centsCount ? score.centsSum / score.centsCount : 0.0, score.centsMax,
+                                    score.readings ? static_cast<double>(score.octaveErrors) / score.readings : 0.0,
+                                    score.stableCases, score.stableCases ? score.stableMillisSum / score.stableCases : 0.0,
+                                    score.samples ? score.nanos / score.samples : 0.0);
+                        firstResult = false;
+                    }
+                }
+            }
+        }
+    }
+    levelSweep(strings, sizeof(strings) / sizeof(strings[0]), signal);
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
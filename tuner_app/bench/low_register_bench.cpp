@@ -0,0 +1,96 @@
+// Low-register check for the bass and extended-range tunings. Plucks the low strings of the 8-string
+// and 5-string bass tunings (plus A1 and E2 for reference) and runs every engine through one
+// StreamingAnalyzer with room for 4096 samples, switching its window between 2048 and 4096 mid-stream
+// the way GuitarTuner::applySettings does. Prints, per engine, mode and window, the worst cents error
+// of the voiced readings and the number of unvoiced ones after the first window has filled.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/low_register_bench.cpp onset_detector.cpp streaming_analyzer.cpp
+//       strobe_tracker.cpp frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp
+//       mcleod_detector.cpp goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp notes.cpp
+//       -o low_register_bench
+#include "bench_signals.h"
+#include "frequency_detector.h"
+#include "notes.h"
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define WINDOW_SIZE 2048
+#define LOW_WINDOW_SIZE 4096
+#define HOP_SIZE 256
+#define SILENCE_RMS 0.01f
+#define NOTE_SAMPLES 48000
+#define SIGNAL_LEVEL 0.3f
+
+int main()
+{
+    const PitchEngine engines[] = {PitchEngine::Autocorrelation, PitchEngine::YIN, PitchEngine::McLeod};
+    const int notes[] = {23, 28, 30, 33, 40}; // B0 E1 F#1 A1 E2
+    const int windows[] = {WINDOW_SIZE, LOW_WINDOW_SIZE};
+    const Tuning &bass = TUNINGS[TUNING_COUNT - 1]; // 5-string bass
+
+    float strings[MAX_STRINGS];
+    for (int s = 0; s < bass.stringCount; ++s)
+        strings[s] = noteFrequency(bass.midi[s]);
+
+    std::vector<float> signal(NOTE_SAMPLES);
+    std::printf("%-16s %-10s %6s", "engine", "mode", "window");
+    for (int midi : notes)
+        std::printf("  %9s%d", noteName(midi), noteOctave(midi));
+    std::printf("\n%35s", "");
+    for (std::size_t n = 0; n < sizeof(notes) / sizeof(notes[0]); ++n)
+        std::printf("  cents/miss");
+    std::printf("\n");
+
+    for (PitchEngine engine : engines)
+    {
+        for (int stringsMode = 0; stringsMode < 2; ++stringsMode)
+        {
+            std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, LOW_WINDOW_SIZE);
+            detector->prepareFrameSize(WINDOW_SIZE);
+            if (stringsMode)
+                detector->setStrings(strings, bass.stringCount);
+            else
+                detector->setChromatic();
+            StreamingAnalyzer analyzer(WINDOW_SIZE, HOP_SIZE, LOW_WINDOW_SIZE);
+            analyzer.setDetector(detector.get());
+            analyzer.setSilenceThreshold(SILENCE_RMS);
+
+            for (int window : windows)
+            {
+                std::printf("%-16s %-10s %6d", FrequencyDetector::engineName(engine),
+                            stringsMode ? "strings" : "chromatic", window);
+                std::mt19937 rng(1234);
+                for (int midi : notes)
+                {
+                    float truth = noteFrequency(midi);
+                    std::fill(signal.begin(), signal.end(), 0.0f);
+                    addPluck(signal, 0, truth, SAMPLE_RATE, SIGNAL_LEVEL, 0.998f, rng);
+                    analyzer.setWindowSize(window);
+
+                    double worst = 0.0;
+                    int misses = 0;
+                    for (int first = 0; first + HOP_SIZE <= NOTE_SAMPLES; first += HOP_SIZE)
+                    {
+                        // Skip readings whose window still reaches back into the previous note
+                        if (analyzer.push(signal.data() + first, HOP_SIZE) == 0 || first < LOW_WINDOW_SIZE)
+                            continue;
+                        float pitch = analyzer.latest().pitch.frequency;
+                        if (pitch <= 0.0f)
+                            ++misses;
+                        else
+                            worst = std::max(worst, static_cast<double>(std::fabs(1200.0f * std::log2(pitch / truth))));
+                    }
+                    std::printf("  %6.1f/%3d", worst, misses);
+                }
+                std::printf("\n");
+            }
+        }
+    }
+    return 0;
+}
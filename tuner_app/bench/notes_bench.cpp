@@ -0,0 +1,113 @@
+// Accuracy and cost of the table-driven note lookup. Over random frequencies in 20-1500 Hz: the
+// error of fastLog2 against std::log2, in cents; for every temperament, how often nearestNote picks
+// another note than a brute-force search over noteFrequency(), and how close to the boundary between
+// the two those inputs were; and ns per call of nearestNote against the plain log2/lround/exp2 lookup
+// for equal temperament.
+// Build from tuner_app/: g++ -O2 -std=c++17 -I. bench/notes_bench.cpp notes.cpp -o notes_bench
+#include "notes.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define INPUTS 1000000
+#define MIN_FREQ 20.0f
+#define MAX_FREQ 1500.0f
+#define REFERENCE_A4 440.0f
+#define REPEATS 5
+
+// Equal-tempered lookup through libm, as the tuner did before the tables
+static NoteInfo libmNote(float freq, float a4)
+{
+    float semitones = 12.0f * std::log2(freq / a4);
+    int midi = static_cast<int>(std::lround(semitones)) + 69;
+    NoteInfo note;
+    note.name = noteName(midi);
+    note.octave = noteOctave(midi);
+    note.midi = midi;
+    note.frequency = a4 * std::exp2((midi - 69) / 12.0f);
+    note.cents = 100.0f * (semitones - (midi - 69));
+    return note;
+}
+
+// Nearest note by distance in cents over all 128; margin is how far the input is from the boundary
+// with the runner-up
+static int bruteForceNote(double freq, Temperament temperament, double &margin)
+{
+    double best = 1e30, second = 1e30;
+    int bestMidi = 0;
+    for (int midi = 0; midi < 128; ++midi)
+    {
+        double distance = std::fabs(1200.0 * std::log2(freq / noteFrequency(midi, REFERENCE_A4, temperament)));
+        if (distance < best)
+        {
+            second = best;
+            best = distance;
+            bestMidi = midi;
+        }
+        else if (distance < second)
+            second = distance;
+    }
+    margin = (second - best) / 2.0;
+    return bestMidi;
+}
+
+template <typename Lookup>
+static double nanosPerCall(const std::vector<float> &inputs, Lookup lookup)
+{
+    double best = 1e30;
+    volatile float sink = 0.0f;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        float sum = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (float freq : inputs)
+            sum += lookup(freq).cents;
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        sink = sink + sum;
+        best = std::min(best, nanos / inputs.size());
+    }
+    return best;
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> logFreq(std::log2(MIN_FREQ), std::log2(MAX_FREQ));
+    std::vector<float> inputs(INPUTS);
+    for (float &freq : inputs)
+        freq = std::exp2(logFreq(rng));
+
+    double log2Error = 0.0;
+    for (float freq : inputs)
+        log2Error = std::max(log2Error, 1200.0 * std::fabs(static_cast<double>(fastLog2(freq)) - std::log2(static_cast<double>(freq))));
+    std::printf("fastLog2: max error %.4f cents\n", log2Error);
+
+    for (int t = 0; t < TEMPERAMENT_COUNT; ++t)
+    {
+        Temperament temperament = static_cast<Temperament>(t);
+        long mismatches = 0;
+        double widestMargin = 0.0;
+        for (float freq : inputs)
+        {
+            double margin;
+            int expected = bruteForceNote(freq, temperament, margin);
+            if (nearestNote(freq, REFERENCE_A4, temperament).midi != expected)
+            {
+                ++mismatches;
+                widestMargin = std::max(widestMargin, margin);
+            }
+        }
+        std::printf("%-17s %ld of %d notes differ, all within %.4f cents of a boundary\n", temperamentName(temperament),
+                    mismatches, INPUTS, widestMargin);
+    }
+
+    double tableNanos = nanosPerCall(inputs, [](float freq)
+                                     { return nearestNote(freq, REFERENCE_A4); });
+    double libmNanos = nanosPerCall(inputs, [](float freq)
+                                    { return libmNote(freq, REFERENCE_A4); });
+    std::printf("nearestNote %.1f ns per call, log2/lround/exp2 %.1f ns\n", tableNanos, libmNanos);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Pluck-to-reading latency with and without onset-triggered analysis. Every trial lets one string
+// ring 20 dB down, then plucks another (with pick noise) at a random offset against the hop grid, and measures
+// the audio time from the attack to the first reading within STABLE_CENTS of the new string and to
+// the first of STABLE_READINGS such readings in a row. Readings further than WRONG_CENTS off between
+// the attack and the stable reading are counted as wrong: what the display flashes meanwhile.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/onset_bench.cpp onset_detector.cpp streaming_analyzer.cpp
+//       strobe_tracker.cpp frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp
+//       mcleod_detector.cpp goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp -o onset_bench
+#include "bench_signals.h"
+#include "frequency_detector.h"
+#include "onset_detector.h"
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define WINDOW_SIZE 2048
+#define HOP_SIZE 256
+#define SILENCE_RMS 0.01f
+#define RING_SAMPLES 12000 // previous string before the pluck
+#define NOTE_SAMPLES 12000 // at most this long after the pluck
+#define TRIALS_PER_STRING 8
+#define STABLE_CENTS 5.0f
+#define STABLE_READINGS 3
+#define WRONG_CENTS 50.0f
+
+static const float strings[] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f};
+
+static float percentile(std::vector<float> values, float p)
+{
+    if (values.empty())
+        return 0.0f;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<std::size_t>(p * values.size()))];
+}
+
+int main()
+{
+    const PitchEngine engines[] = {PitchEngine::Autocorrelation, PitchEngine::YIN, PitchEngine::McLeod};
+    const DetectionMode modes[] = {DetectionMode::Target, DetectionMode::Strings, DetectionMode::Chromatic};
+    const char *modeNames[] = {"target", "strings", "chromatic"};
+
+    std::printf("%-16s %-10s %-7s %8s %8s %8s   %8s %8s %8s %7s %7s\n", "engine", "mode", "onsets", "p50 ms",
+                "p90 ms", "max ms", "stable50", "stable90", "max", "missed", "wrong/trial");
+    for (PitchEngine engine : engines)
+    {
+        std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, WINDOW_SIZE);
+        detector->setCorrelationMethod(CorrelationMethod::FFT);
+        for (int m = 0; m < 3; ++m)
+        {
+            for (int withOnsets = 0; withOnsets < 2; ++withOnsets)
+            {
+                OnsetDetector onsets(SAMPLE_RATE);
+                onsets.setSilenceThreshold(SILENCE_RMS);
+                StreamingAnalyzer analyzer(WINDOW_SIZE, HOP_SIZE);
+                analyzer.setDetector(detector.get());
+                analyzer.setSilenceThreshold(SILENCE_RMS);
+                analyzer.setOnsets(withOnsets ? &onsets : nullptr);
+
+                // Identical signals for both variants
+                std::mt19937 rng(7);
+                std::vector<float> first, stable;
+                int missed = 0, wrong = 0, trials = 0;
+                for (int s = 0; s < 6; ++s)
+                {
+                    if (modes[m] == DetectionMode::Target)
+                        detector->setTarget(strings[s]);
+                    else if (modes[m] == DetectionMode::Strings)
+                        detector->setStrings(strings, 6);
+                    else
+                        detector->setChromatic();
+
+                    for (int t = 0; t < TRIALS_PER_STRING; ++t)
+                    {
+                        std::size_t attack = RING_SAMPLES + rng() % HOP_SIZE;
+                        std::vector<float> signal(attack + NOTE_SAMPLES, 0.0f);
+                        addPluck(signal, 0, strings[(s + 1 + t % 5) % 6], SAMPLE_RATE, 0.05f, 0.998f, rng);
+                        addPluck(signal, attack, strings[s], SAMPLE_RATE, 0.5f, 0.998f, rng);
+
+                        // Pick noise: 2 ms of decaying noise on the attack, plus a low noise floor
+                        std::normal_distribution<float> noise(0.0f, 1.0f);
+                        for (std::size_t i = 0; i < signal.size(); ++i)
+                        {
+                            if (i >= attack && i < attack + SAMPLE_RATE / 500)
+                                signal[i] += 0.3f * noise(rng) * std::exp(-static_cast<float>(i - attack) / (SAMPLE_RATE / 2000.0f));
+                            signal[i] += 0.001f * noise(rng);
+                        }
+
+                        analyzer.reset();
+                        ++trials;
+                        float firstMs = -1.0f, stableMs = -1.0f;
+                        int streak = 0;
+                        for (std::size_t at = 0; at + HOP_SIZE <= signal.size(); at += HOP_SIZE)
+                        {
+                            if (analyzer.push(signal.data() + at, HOP_SIZE) == 0)
+                                continue;
+                            const StreamReading &reading = analyzer.latest();
+                            if (reading.endSample <= static_cast<long long>(attack) || reading.pitch.frequency <= 0.0f)
+                                continue;
+
+                            float ms = 1000.0f * (reading.endSample - attack) / SAMPLE_RATE;
+                            float cents = std::fabs(1200.0f * std::log2(reading.pitch.frequency / strings[s]));
+                            if (cents > WRONG_CENTS)
+                                ++wrong;
+                            streak = cents <= STABLE_CENTS ? streak + 1 : 0;
+                            if (streak == 1 && firstMs < 0.0f)
+                                firstMs = ms;
+                            if (streak == STABLE_READINGS)
+                            {
+                                stableMs = ms;
+                                break;
+                            }
+                        }
+                        if (firstMs < 0.0f)
+                            ++missed;
+                        else
+                            first.push_back(firstMs);
+                        if (stableMs >= 0.0f)
+                            stable.push_back(stableMs);
+                    }
+                }
+
+                std::printf("%-16s %-10s %-7s %8.1f %8.1f %8.1f   %8.1f %8.1f %8.1f %7d %7.2f\n",
+                            FrequencyDetector::engineName(engine), modeNames[m], withOnsets ? "on" : "off",
+                            percentile(first, 0.5f), percentile(first, 0.9f), percentile(first, 1.0f),
+                            percentile(stable, 0.5f), percentile(stable, 0.9f), percentile(stable, 1.0f), missed,
+                            static_cast<float>(wrong) / trials);
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+// TunerPipeline fed in real time by a synthetic audio thread: every BUFFER_SIZE frames of a tone per
+// input (110 Hz times the input number) go to pushBlock() on the buffer clock, as the RtAudio callback
+// would, and halfway through every input is retargeted to its tone. Prints the pipeline stats at the
+// end, with the frames the render thread drew and the longest gap between two of them, and the blocks
+// whose analysis allocated (counted unless built with -DNDEBUG). Build with -fsanitize=thread (and
+// -O1 -g) to check the queues and snapshots for races; the worker falls behind under it, so blocks
+// are dropped there.
+//   pipeline_bench [inputs [seconds]]   (2 inputs, 2 s)
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -pthread -I. bench/pipeline_bench.cpp tuner_pipeline.cpp streaming_analyzer.cpp
+//       strobe_tracker.cpp frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp
+//       mcleod_detector.cpp goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp onset_detector.cpp
+//       notes.cpp alloc_counter.cpp -o pipeline_bench
+#include "frequency_detector.h"
+#include "streaming_analyzer.h"
+#include "tuner_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define BUFFER_SIZE 256
+#define WINDOW_SIZE 2048
+#define HOP_SIZE 256
+#define SILENCE_RMS 0.01f
+#define BASE_FREQ 110.0
+#define SIGNAL_LEVEL 0.3
+
+static void printLatency(const char *name, const StageLatency &latency)
+{
+    std::printf("  %-9s %8llu   avg %8.1f us   max %8.1f us\n", name, static_cast<unsigned long long>(latency.count),
+                latency.avgMicros, latency.maxMicros);
+}
+
+int main(int argc, char *argv[])
+{
+    int inputs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+
+    std::vector<std::unique_ptr<FrequencyDetector>> detectors;
+    std::vector<std::unique_ptr<StreamingAnalyzer>> analyzers;
+    std::vector<StreamingAnalyzer *> pointers;
+    for (int c = 0; c < inputs; ++c)
+    {
+        detectors.push_back(FrequencyDetector::create(PitchEngine::McLeod, SAMPLE_RATE, WINDOW_SIZE));
+        detectors.back()->setChromatic();
+        analyzers.emplace_back(new StreamingAnalyzer(WINDOW_SIZE, HOP_SIZE));
+        analyzers.back()->setDetector(detectors.back().get());
+        analyzers.back()->setSilenceThreshold(SILENCE_RMS);
+        pointers.push_back(analyzers.back().get());
+    }
+
+    // Runs on the channel's worker, as GuitarTuner::applySettings does
+    auto apply = [&detectors](int channel, const TunerSettings &s)
+    {
+        if (s.mode == DetectionMode::Target)
+            detectors[channel]->setTarget(s.targetFreq);
+        else
+            detectors[channel]->setChromatic();
+    };
+    // Render thread only; read after stop()
+    long long frames = 0;
+    PipelineClock::time_point lastFrame;
+    PipelineClock::duration longestGap{0};
+    auto render = [&](const std::vector<TunerReading> &)
+    {
+        PipelineClock::time_point now = PipelineClock::now();
+        if (frames++ > 0)
+            longestGap = std::max(longestGap, now - lastFrame);
+        lastFrame = now;
+    };
+    TunerPipeline pipeline(pointers, apply, render);
+    pipeline.start();
+
+    // Audio thread: one interleaved buffer per BUFFER_SIZE frames of wall time
+    std::vector<float> buffer(static_cast<std::size_t>(BUFFER_SIZE) * inputs);
+    const long long totalFrames = static_cast<long long>(seconds * SAMPLE_RATE);
+    const PipelineClock::duration period =
+        std::chrono::duration_cast<PipelineClock::duration>(std::chrono::duration<double>(static_cast<double>(BUFFER_SIZE) / SAMPLE_RATE));
+    std::thread audio([&]()
+                      {
+        PipelineClock::time_point next = PipelineClock::now();
+        for (long long frame = 0; frame < totalFrames; frame += BUFFER_SIZE)
+        {
+            for (int i = 0; i < BUFFER_SIZE; ++i)
+            {
+                double t = static_cast<double>(frame + i) / SAMPLE_RATE;
+                for (int c = 0; c < inputs; ++c)
+                    buffer[static_cast<std::size_t>(i) * inputs + c] =
+                        static_cast<float>(SIGNAL_LEVEL * std::sin(6.283185307179586 * BASE_FREQ * (c + 1) * t));
+            }
+            pipeline.pushBlock(buffer.data(), BUFFER_SIZE);
+            next += period;
+            std::this_thread::sleep_until(next);
+        } });
+
+    // UI thread: retarget every input halfway through
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+    for (int c = 0; c < inputs; ++c)
+    {
+        TunerSettings settings;
+        settings.sequence = 1;
+        settings.mode = DetectionMode::Target;
+        settings.targetFreq = static_cast<float>(BASE_FREQ * (c + 1));
+        settings.issued = PipelineClock::now();
+        if (!pipeline.postSettings(c, settings))
+            std::printf("input %d: settings queue full\n", c + 1);
+    }
+
+    audio.join();
+    pipeline.stop();
+
+    PipelineStats stats = pipeline.getStats();
+    std::printf("%d inputs, %.1f s on %d workers\n", inputs, seconds, pipeline.getWorkerCount());
+    std::printf("  blocks    %8llu   dropped %llu\n", static_cast<unsigned long long>(stats.blocks),
+                static_cast<unsigned long long>(stats.droppedBlocks));
+    std::printf("  readings  %8llu   skipped between frames %llu\n", static_cast<unsigned long long>(stats.readings),
+                static_cast<unsigned long long>(stats.skippedReadings));
+    std::printf("  frames    %8lld   longest gap %.1f ms\n", frames,
+                std::chrono::duration<double, std::milli>(longestGap).count());
+    printLatency("queue", stats.queue);
+    printLatency("analysis", stats.analysis);
+    printLatency("render", stats.render);
+    printLatency("retarget", stats.retarget);
+    std::printf("  analysis  %.1f ms wall, %.1f ms CPU\n", stats.analysisSeconds * 1000.0, stats.analysisCpuSeconds * 1000.0);
+    std::printf("  allocating analysis blocks %llu\n", static_cast<unsigned long long>(stats.allocatingBlocks));
+    return 0;
+}
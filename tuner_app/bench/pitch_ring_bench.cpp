@@ -0,0 +1,235 @@
+// Shared-memory pitch ring: a reader example and a multi-process check of the ring.
+//   pitch_ring_bench follow NAME            print what `tuner --headless NAME` publishes (reader example)
+//   pitch_ring_bench                        POSIX: fork one writer and two readers, one of which spends
+//                                           SLOW_READER_MICROS on every record, first at PACED_RATE
+//                                           records/s, then back to back, and report per reader the
+//                                           records delivered, lost, corrupt and out of order
+//   pitch_ring_bench write NAME N RATE      the writer half: N records at RATE/s (0: back to back)
+//   pitch_ring_bench check NAME MICROS      the reader half, MICROS per record; start it first
+// The exit status is 1 if any reader got a corrupt or out-of-order record.
+// Build from tuner_app/: g++ -O2 -std=c++17 -I. bench/pitch_ring_bench.cpp pitch_ring.cpp notes.cpp -o pitch_ring_bench
+#include "notes.h"
+#include "pitch_ring.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define RING_CAPACITY 1024
+#define PACED_RECORDS 10000
+#define PACED_RATE 10000.0
+#define FLOOD_RECORDS 2000000
+#define SLOW_READER_MICROS 5
+#define END_FLAG 0x80                                 // last record of a run
+#define ATTACH_GRACE std::chrono::milliseconds(200)   // writer: time for the readers to attach
+#define ATTACH_TIMEOUT std::chrono::seconds(5)
+#define STALL_TIMEOUT std::chrono::seconds(5)         // reader: give up if nothing arrives for this long
+
+using BenchClock = std::chrono::steady_clock;
+
+// Record i carries values derived from i, so a reader can tell a torn or misplaced copy
+static PitchSample testSample(std::uint64_t i)
+{
+    PitchSample sample;
+    sample.timeNanos = static_cast<std::int64_t>(i * 3 + 1);
+    sample.frequency = static_cast<float>(i & 0xFFFF);
+    sample.midi = static_cast<int>(i % 128);
+    return sample;
+}
+
+static bool matches(const PitchSample &sample)
+{
+    PitchSample expected = testSample(sample.index);
+    return sample.timeNanos == expected.timeNanos && sample.frequency == expected.frequency &&
+           sample.midi == expected.midi;
+}
+
+static void spinFor(std::chrono::nanoseconds delay)
+{
+    BenchClock::time_point until = BenchClock::now() + delay;
+    while (BenchClock::now() < until)
+    {
+    }
+}
+
+static int writeRecords(const std::string &name, std::uint64_t records, double rate)
+{
+    PitchRingWriter ring(name, 1, RING_CAPACITY);
+    std::this_thread::sleep_for(ATTACH_GRACE);
+
+    BenchClock::time_point start = BenchClock::now();
+    for (std::uint64_t i = 0; i < records; ++i)
+    {
+        if (rate > 0.0)
+            spinFor(start + std::chrono::nanoseconds(static_cast<long long>(i * 1e9 / rate)) - BenchClock::now());
+        ring.publish(0, testSample(i));
+    }
+    double seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+
+    PitchSample end;
+    end.flags = END_FLAG;
+    ring.publish(0, end);
+    if (rate > 0.0)
+        std::printf("writer: %llu records in %.2f s\n", static_cast<unsigned long long>(records), seconds);
+    else
+        std::printf("writer: %llu records back to back, %.1f ns per record\n", static_cast<unsigned long long>(records),
+                    seconds * 1e9 / records);
+    std::fflush(stdout);
+
+    // Readers keep their mapping after the segment goes, but on Windows a late one could not attach
+    std::this_thread::sleep_for(ATTACH_GRACE);
+    return 0;
+}
+
+static int checkRecords(const std::string &name, int delayMicros)
+{
+    std::unique_ptr<PitchRingReader> ring;
+    BenchClock::time_point deadline = BenchClock::now() + ATTACH_TIMEOUT;
+    while (!ring)
+    {
+        try
+        {
+            ring.reset(new PitchRingReader(name));
+        }
+        catch (const std::runtime_error &)
+        {
+            if (BenchClock::now() > deadline)
+            {
+                std::fprintf(stderr, "reader: no ring named %s\n", name.c_str());
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::uint64_t delivered = 0, corrupt = 0, reordered = 0;
+    bool started = false, ended = false;
+    std::uint64_t last = 0;
+    BenchClock::time_point progress = BenchClock::now();
+    while (!ended && BenchClock::now() - progress < STALL_TIMEOUT)
+    {
+        PitchSample sample;
+        if (!ring->next(0, sample))
+        {
+            // Caught up: done if the end record went by, even if it was lost in the rush
+            ended = ring->latest(0, sample) && (sample.flags & END_FLAG);
+            std::this_thread::yield();
+            continue;
+        }
+        progress = BenchClock::now();
+        if (sample.flags & END_FLAG)
+        {
+            ended = true;
+            break;
+        }
+        ++delivered;
+        if (!matches(sample))
+            ++corrupt;
+        if (started && sample.index <= last)
+            ++reordered;
+        started = true;
+        last = sample.index;
+        if (delayMicros > 0)
+            spinFor(std::chrono::microseconds(delayMicros));
+    }
+
+    std::printf("reader (%d us per record): %llu delivered, %llu lost, %llu corrupt, %llu out of order%s\n", delayMicros,
+                static_cast<unsigned long long>(delivered), static_cast<unsigned long long>(ring->getLost(0)),
+                static_cast<unsigned long long>(corrupt), static_cast<unsigned long long>(reordered),
+                ended ? "" : " (writer stalled)");
+    std::fflush(stdout);
+    return corrupt > 0 || reordered > 0 || !ended ? 1 : 0;
+}
+
+// Reader example: follow every input of a headless tuner until interrupted
+static int follow(const std::string &name)
+{
+    PitchRingReader ring(name);
+    std::printf("Following %d input(s) of %s\n", ring.getChannelCount(), name.c_str());
+    for (;;)
+    {
+        bool any = false;
+        PitchSample sample;
+        for (int c = 0; c < ring.getChannelCount(); ++c)
+        {
+            while (ring.next(c, sample))
+            {
+                any = true;
+                if (sample.midi < 0)
+                    continue;
+                std::printf("channel %d  %s%d %+6.1f cents %8.2f Hz%s\n", sample.channel, noteName(sample.midi),
+                            noteOctave(sample.midi), sample.cents, sample.frequency,
+                            (sample.flags & PITCH_ONSET) ? "  (onset)" : "");
+            }
+        }
+        if (!any)
+        {
+            std::fflush(stdout);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+#ifndef _WIN32
+// One writer and a fast and a slow reader, each in its own process
+static int forkRun(const std::string &name, std::uint64_t records, double rate)
+{
+    std::fflush(stdout);
+    pid_t children[3];
+    for (int p = 0; p < 3; ++p)
+    {
+        children[p] = fork();
+        if (children[p] == 0)
+            std::exit(p == 0 ? writeRecords(name, records, rate) : checkRecords(name, p == 1 ? 0 : SLOW_READER_MICROS));
+    }
+    int failed = 0;
+    for (pid_t child : children)
+    {
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = 1;
+    }
+    return failed;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        std::string mode = argc > 1 ? argv[1] : "";
+        if (mode == "follow" && argc == 3)
+            return follow(argv[2]);
+        if (mode == "write" && argc == 5)
+            return writeRecords(argv[2], std::strtoull(argv[3], nullptr, 10), std::atof(argv[4]));
+        if (mode == "check" && argc == 4)
+            return checkRecords(argv[2], std::atoi(argv[3]));
+#ifndef _WIN32
+        if (argc == 1)
+        {
+            // Unique per run, so no reader finds a segment left behind by an earlier one
+            std::string name = "/pitch_ring_bench_" + std::to_string(getpid());
+            std::printf("%d records at %.0f/s:\n", PACED_RECORDS, PACED_RATE);
+            int failed = forkRun(name, PACED_RECORDS, PACED_RATE);
+            std::printf("%d records back to back:\n", FLOOD_RECORDS);
+            failed |= forkRun(name, FLOOD_RECORDS, 0.0);
+            return failed;
+        }
+#endif
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    std::fprintf(stderr, "Usage: pitch_ring_bench [follow NAME | write NAME RECORDS RATE | check NAME MICROS]\n");
+    return 2;
+}
@@ -0,0 +1,87 @@
+// Micro-benchmark for the SIMD kernels: checks every supported ISA level against the scalar
+// reference within SIMD_TOLERANCE and reports ns per call and speedup over scalar.
+// Build from tuner_app/: g++ -O2 -std=c++17 bench/simd_bench.cpp simd_kernels.cpp -I. -o simd_bench
+#include "simd_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define FRAME 2048
+#define REPEATS 20000
+
+// Keeps the optimizer from discarding benchmark results
+static volatile float sink;
+
+template <typename F>
+static double nanosPerCall(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; ++r)
+        f();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / REPEATS;
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> a(FRAME), b(FRAME), out(FRAME);
+    for (int i = 0; i < FRAME; ++i)
+    {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+    }
+
+    const SimdKernels &scalar = kernelsFor(SimdLevel::Scalar);
+    SimdLevel best = detectSimdLevel();
+    std::printf("Detected: %s, active: %s, frame: %d samples\n\n", simdLevelName(best),
+                simdLevelName(activeKernels().level), FRAME);
+
+    // Tolerance reference: sum of |a[i] * b[i]| over the largest tested length
+    double magnitude = 0.0;
+    for (int i = 0; i < FRAME; ++i)
+        magnitude += std::fabs(a[i] * b[i]);
+
+    double base[3] = {0, 0, 0};
+    std::printf("%-8s %12s %12s %12s %9s %9s %9s %s\n", "level", "dot ns", "mul ns", "sumsq ns", "dot x", "mul x", "sumsq x", "check");
+    for (int l = 0; l <= static_cast<int>(best); ++l)
+    {
+        const SimdKernels &k = kernelsFor(static_cast<SimdLevel>(l));
+
+        // Validate every length up to the frame so all tail paths are exercised
+        bool ok = true;
+        for (int n = 0; n <= FRAME && ok; n += (n < 64 ? 1 : 61))
+        {
+            ok = std::fabs(k.dot(a.data(), b.data(), n) - scalar.dot(a.data(), b.data(), n)) <= SIMD_TOLERANCE * magnitude &&
+                 std::fabs(k.sumSquares(a.data(), n) - scalar.sumSquares(a.data(), n)) <= SIMD_TOLERANCE * n;
+            k.multiply(a.data(), b.data(), out.data(), n);
+            for (int i = 0; i < n && ok; ++i)
+                ok = out[i] == a[i] * b[i];
+
+            // FMA rounds once, so allow one ulp-scale difference from the scalar multiply-add
+            std::fill(out.begin(), out.end(), 1.0f);
+            k.multiplyAdd(a.data(), 0.5f, out.data(), n);
+            for (int i = 0; i < n && ok; ++i)
+                ok = std::fabs(out[i] - (1.0f + 0.5f * a[i])) <= SIMD_TOLERANCE;
+        }
+
+        double t[3];
+        t[0] = nanosPerCall([&]
+                            { sink = k.dot(a.data(), b.data(), FRAME); });
+        t[1] = nanosPerCall([&]
+                            { k.multiply(a.data(), b.data(), out.data(), FRAME); sink = out[FRAME / 2]; });
+        t[2] = nanosPerCall([&]
+                            { sink = k.sumSquares(a.data(), FRAME); });
+        if (l == 0)
+            for (int i = 0; i < 3; ++i)
+                base[i] = t[i];
+
+        std::printf("%-8s %12.1f %12.1f %12.1f %8.2fx %8.2fx %8.2fx %s\n", simdLevelName(k.level), t[0], t[1], t[2],
+                    base[0] / t[0], base[1] / t[1], base[2] / t[2], ok ? "ok" : "MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Wrong-string picks in auto string mode. Plucks every string of standard tuning, detuned by up to
+// +-30 cents, through StreamingAnalyzer with the detector scoring all six strings, and counts per
+// engine and window the readings that named another string than the one plucked, and the readings
+// that found no string at all, once the first window has filled.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/strings_bench.cpp streaming_analyzer.cpp strobe_tracker.cpp
+//       frequency_detector.cpp autocorrelation_detector.cpp yin_detector.cpp mcleod_detector.cpp
+//       goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp onset_detector.cpp notes.cpp -o strings_bench
+#include "bench_signals.h"
+#include "frequency_detector.h"
+#include "notes.h"
+#include "streaming_analyzer.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define HOP_SIZE 256
+#define SILENCE_RMS 0.01f
+#define NOTE_SAMPLES 48000
+#define SIGNAL_LEVEL 0.3f
+
+int main()
+{
+    const PitchEngine engines[] = {PitchEngine::Autocorrelation, PitchEngine::YIN, PitchEngine::McLeod};
+    const int windows[] = {1024, 2048};
+    const float detunings[] = {-30.0f, -15.0f, 0.0f, 15.0f, 30.0f};
+    const Tuning &standard = TUNINGS[0];
+
+    float strings[MAX_STRINGS];
+    for (int s = 0; s < standard.stringCount; ++s)
+        strings[s] = noteFrequency(standard.midi[s]);
+
+    std::vector<float> signal(NOTE_SAMPLES);
+    std::printf("%-16s %6s %9s %12s %9s\n", "engine", "window", "readings", "wrong string", "no string");
+    for (PitchEngine engine : engines)
+    {
+        for (int window : windows)
+        {
+            std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(engine, SAMPLE_RATE, window);
+            detector->setStrings(strings, standard.stringCount);
+            StreamingAnalyzer analyzer(window, HOP_SIZE);
+            analyzer.setDetector(detector.get());
+            analyzer.setSilenceThreshold(SILENCE_RMS);
+
+            // Same seed for every engine and window, so they all see identical plucks
+            std::mt19937 rng(1234);
+            long readings = 0, wrong = 0, missing = 0;
+            for (int s = 0; s < standard.stringCount; ++s)
+            {
+                for (float detune : detunings)
+                {
+                    std::fill(signal.begin(), signal.end(), 0.0f);
+                    addPluck(signal, 0, strings[s] * std::pow(2.0f, detune / 1200.0f), SAMPLE_RATE, SIGNAL_LEVEL,
+                             0.996f, rng);
+                    analyzer.reset();
+                    for (int first = 0; first + HOP_SIZE <= NOTE_SAMPLES; first += HOP_SIZE)
+                    {
+                        if (analyzer.push(signal.data() + first, HOP_SIZE) == 0 || analyzer.latest().rms < SILENCE_RMS)
+                            continue;
+                        ++readings;
+                        int picked = analyzer.latest().pitch.stringIndex;
+                        if (picked < 0)
+                            ++missing;
+                        else if (picked != s)
+                            ++wrong;
+                    }
+                }
+            }
+            std::printf("%-16s %6d %9ld %12ld %9ld\n", FrequencyDetector::engineName(engine), window, readings, wrong,
+                        missing);
+        }
+    }
+    return 0;
+}
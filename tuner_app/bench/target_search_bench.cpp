@@ -0,0 +1,114 @@
+// Target mode with the Goertzel filter bank against each engine's own lag search. For every string
+// of standard tuning, TONES_PER_STRING slightly inharmonic tones spread over +-100 cents around the
+// string are analyzed as single 2048-sample frames with the detector aimed at the string, clean and
+// at 20 dB SNR. As on a real string, partial h sits at h * f * sqrt((1 + B h^2) / (1 + B)), the
+// fundamental at f. Prints per search the mean and worst cents error of the fundamental, the mean
+// per string, and us per frame.
+// Build from tuner_app/:
+//   g++ -O2 -std=c++17 -I. bench/target_search_bench.cpp frequency_detector.cpp autocorrelation_detector.cpp
+//       yin_detector.cpp mcleod_detector.cpp goertzel_bank.cpp decimator.cpp fft.cpp simd_kernels.cpp
+//       -o target_search_bench
+#include "frequency_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define FRAME_SIZE 2048
+#define TONES_PER_STRING 100
+#define PARTIALS 6
+#define INHARMONICITY 1e-4 // B of a wound guitar string
+#define SIGNAL_LEVEL 0.3f
+#define NOISY_SNR_DB 20.0
+#define STRING_COUNT 6
+
+static const float STRINGS[STRING_COUNT] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f};
+
+static void inharmonicTone(double freq, double snrDb, std::mt19937 &rng, std::vector<float> &out)
+{
+    std::uniform_real_distribution<double> phaseDist(0.0, 6.283185307179586);
+    double phases[PARTIALS];
+    for (double &p : phases)
+        p = phaseDist(rng);
+
+    // Partial h relative to h * freq, with the fundamental itself at freq
+    double stretch[PARTIALS];
+    for (int h = 1; h <= PARTIALS; ++h)
+        stretch[h - 1] = std::sqrt((1.0 + INHARMONICITY * h * h) / (1.0 + INHARMONICITY));
+
+    double energy = 0.0;
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        double t = static_cast<double>(i) / SAMPLE_RATE, v = 0.0;
+        for (int h = 1; h <= PARTIALS; ++h)
+            v += std::sin(6.283185307179586 * h * freq * stretch[h - 1] * t + phases[h - 1]) / h;
+        out[i] = static_cast<float>(SIGNAL_LEVEL / 2.0 * v);
+        energy += static_cast<double>(out[i]) * out[i];
+    }
+    if (snrDb <= 0.0)
+        return;
+    std::normal_distribution<double> noise(0.0, std::sqrt(energy / out.size()) * std::pow(10.0, -snrDb / 20.0));
+    for (float &s : out)
+        s += static_cast<float>(noise(rng));
+}
+
+struct Search
+{
+    PitchEngine engine;
+    CorrelationMethod method;
+    TargetSearch search;
+    const char *name;
+};
+
+int main()
+{
+    const Search searches[] = {{PitchEngine::McLeod, CorrelationMethod::FFT, TargetSearch::FilterBank, "filter bank"},
+                               {PitchEngine::Autocorrelation, CorrelationMethod::Direct, TargetSearch::Lags, "Autocorr Direct"},
+                               {PitchEngine::Autocorrelation, CorrelationMethod::FFT, TargetSearch::Lags, "Autocorr FFT"},
+                               {PitchEngine::YIN, CorrelationMethod::FFT, TargetSearch::Lags, "YIN FFT"},
+                               {PitchEngine::McLeod, CorrelationMethod::FFT, TargetSearch::Lags, "McLeod FFT"}};
+    const double snrs[] = {0.0, NOISY_SNR_DB};
+
+    std::vector<float> frame(FRAME_SIZE);
+    std::printf("%-16s %5s %8s %8s %7s  mean by string E2 A2 D3 G3 B3 E4\n", "search", "snr", "mean", "max", "us");
+    for (const Search &search : searches)
+    {
+        std::unique_ptr<FrequencyDetector> detector = FrequencyDetector::create(search.engine, SAMPLE_RATE, FRAME_SIZE);
+        detector->setCorrelationMethod(search.method);
+        detector->setTargetSearch(search.search);
+        for (double snr : snrs)
+        {
+            // Same seed for every search, so they all see identical tones
+            std::mt19937 rng(99);
+            std::uniform_real_distribution<double> detuneDist(-100.0, 100.0);
+            double sum = 0.0, worst = 0.0, micros = 0.0, byString[STRING_COUNT] = {};
+            for (int s = 0; s < STRING_COUNT; ++s)
+            {
+                detector->setTarget(STRINGS[s]);
+                for (int tone = 0; tone < TONES_PER_STRING; ++tone)
+                {
+                    double truth = STRINGS[s] * std::pow(2.0, detuneDist(rng) / 1200.0);
+                    inharmonicTone(truth, snr, rng, frame);
+                    auto start = std::chrono::steady_clock::now();
+                    float found = detector->analyze(frame.data(), FRAME_SIZE).frequency;
+                    micros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                    double cents = found > 0.0f ? std::fabs(1200.0 * std::log2(found / truth)) : 1200.0;
+                    sum += cents;
+                    worst = std::max(worst, cents);
+                    byString[s] += cents / TONES_PER_STRING;
+                }
+            }
+            int tones = STRING_COUNT * TONES_PER_STRING;
+            std::printf("%-16s %5s %8.2f %8.2f %7.1f ", search.name, snr > 0.0 ? "20 dB" : "clean", sum / tones, worst,
+                        micros / tones);
+            for (double mean : byString)
+                std::printf(" %5.2f", mean);
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "decimator.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#define PI 3.14159265358979323846
+
+// Fraction of the input rate each stage passes untouched; the band from 0.5 - PASSBAND up to
+// Nyquist is stopband, so nothing folds back below PASSBAND when the rate is halved
+#define PASSBAND 0.15
+
+HalfBandDecimator::HalfBandDecimator(int maxInputSize)
+{
+    // Blackman-windowed half-band sinc: h[0] = 1/2, h[n] = 0 for even n != 0
+    int length = 4 * HALF_TAPS - 1;
+    int centre = length / 2;
+    taps.resize(2 * HALF_TAPS);
+    double sum = 0.0;
+    for (int t = 0; t < 2 * HALF_TAPS; ++t)
+    {
+        int n = 2 * t - 2 * HALF_TAPS + 1;
+        double x = PI * n / 2.0;
+        double w = 0.42 + 0.5 * std::cos(PI * n / (centre + 1)) + 0.08 * std::cos(2.0 * PI * n / (centre + 1));
+        taps[t] = static_cast<float>(0.5 * std::sin(x) / x * w);
+        sum += taps[t];
+    }
+
+    // Unity gain at DC
+    for (float &tap : taps)
+        tap = static_cast<float>(tap * 0.5 / sum);
+
+    configure(maxInputSize);
+}
+
+void HalfBandDecimator::configure(int maxInputSize)
+{
+    oddPhase.assign(maxInputSize / 2 + 2 * HALF_TAPS, 0.0f);
+    firstStage.assign(maxInputSize / 2 + 1, 0.0f);
+    secondStage.assign(maxInputSize / 4 + 1, 0.0f);
+}
+
+int HalfBandDecimator::chooseFactor(float sampleRate, float maxFreq, int harmonics)
+{
+    int factor = MAX_FACTOR;
+    while (factor > 1 && harmonics * maxFreq > PASSBAND * 2.0 * sampleRate / factor)
+        factor /= 2;
+    return factor;
+}
+
+int HalfBandDecimator::process(const float *input, int size, int factor, float *out)
+{
+    if (factor <= 1)
+    {
+        std::copy(input, input + size, out);
+        return size;
+    }
+
+    // Halve into the scratch buffers; the last stage writes straight into out
+    const float *source = input;
+    float *scratch[2] = {firstStage.data(), secondStage.data()};
+    for (int s = 0; factor > 2; ++s, factor /= 2)
+    {
+        size = decimateByTwo(source, size, scratch[s]);
+        source = scratch[s];
+    }
+    return decimateByTwo(source, size, out);
+}
+
+// y[m] = x[2m] / 2 + sum_t taps[t] * x[2(m - HALF_TAPS + t) + 1]; samples outside the frame are zero
+int HalfBandDecimator::decimateByTwo(const float *input, int size, float *out)
+{
+    int half = size / 2;
+    float *odd = oddPhase.data() + HALF_TAPS;
+    for (int i = 0; i < half; ++i)
+        odd[i] = input[2 * i + 1];
+    std::fill(odd + half, odd + half + HALF_TAPS, 0.0f);
+
+    // Centre tap, then one vectorized pass over all outputs per odd tap
+    const SimdKernels &kernels = activeKernels();
+    for (int m = 0; m < half; ++m)
+        out[m] = 0.5f * input[2 * m];
+    for (int t = 0; t < 2 * HALF_TAPS; ++t)
+        kernels.multiplyAdd(odd + t - HALF_TAPS, taps[t], out, half);
+    return half;
+}
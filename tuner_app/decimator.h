@@ -0,0 +1,34 @@
+#include <vector>
+#pragma once
+
+// Anti-aliased decimation by 2, 4 or 8 through a cascade of identical half-band FIR stages.
+// Each stage is run in polyphase form: the even input samples only meet the centre tap and the odd
+// samples only meet the non-zero odd taps, so a stage is one vectorized multiply-add per odd tap,
+// each covering every output of the stage at once.
+// Buffers are sized up front; process() does not allocate.
+class HalfBandDecimator
+{
+public:
+    static constexpr int MAX_FACTOR = 8;
+
+    explicit HalfBandDecimator(int maxInputSize);
+
+    // (Re)allocate for a new maximum input size. Not real-time safe.
+    void configure(int maxInputSize);
+
+    // Filter and decimate size samples by factor (1, 2, 4 or 8) into out; returns size / factor
+    int process(const float *input, int size, int factor, float *out);
+
+    // Largest factor whose passband still holds maxFreq and its harmonics up to the given one
+    static int chooseFactor(float sampleRate, float maxFreq, int harmonics = 2);
+
+private:
+    static constexpr int HALF_TAPS = 8; // non-zero odd taps on each side of the centre, 31-tap filter
+
+    int decimateByTwo(const float *input, int size, float *out);
+
+    std::vector<float> taps;     // odd taps h[-15], h[-13], ..., h[15]
+    std::vector<float> oddPhase; // odd input samples with HALF_TAPS zeros of padding on each side
+    std::vector<float> firstStage;  // output of the first stage when factor > 2
+    std::vector<float> secondStage; // output of the second stage when factor == 8
+};
@@ -0,0 +1,96 @@
+#include "fft.h"
+#include <stdexcept>
+#include <utility>
+#define PI 3.14159265358979323846
+
+// Constructor: precompute bit-reversal permutation and twiddle factors for the given size
+FFT::FFT(int size) : n(size)
+{
+    if (size < 2 || (size & (size - 1)) != 0)
+        throw std::invalid_argument("FFT size must be a power of two");
+
+    int bits = 0;
+    while ((1 << bits) < n)
+        ++bits;
+
+    bitReverse.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        bitReverse[i] = r;
+    }
+
+    // Forward twiddles e^(-2*pi*i*k/n) for k < n/2, computed in double to keep large plans accurate
+    twiddles.resize(n / 2);
+    for (int k = 0; k < n / 2; ++k)
+    {
+        double angle = -2.0 * PI * k / n;
+        twiddles[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+}
+
+int FFT::size() const
+{
+    return n;
+}
+
+void FFT::forward(std::complex<float> *data) const
+{
+    transform(data, false);
+}
+
+void FFT::inverse(std::complex<float> *data) const
+{
+    transform(data, true);
+
+    float scale = 1.0f / n;
+    for (int i = 0; i < n; ++i)
+        data[i] *= scale;
+}
+
+int FFT::nextPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+// Iterative in-place Cooley-Tukey transform
+void FFT::transform(std::complex<float> *data, bool invert) const
+{
+    for (int i = 0; i < n; ++i)
+    {
+        int j = bitReverse[i];
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        int half = len / 2;
+        int step = n / len;
+        for (int start = 0; start < n; start += len)
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                const std::complex<float> &w = twiddles[k * step];
+                float wr = w.real();
+                float wi = invert ? -w.imag() : w.imag();
+
+                std::complex<float> &a = data[start + k];
+                std::complex<float> &b = data[start + k + half];
+
+                // Complex multiply written out to avoid the slow NaN-checking path of operator*
+                float vr = b.real() * wr - b.imag() * wi;
+                float vi = b.real() * wi + b.imag() * wr;
+
+                b = std::complex<float>(a.real() - vr, a.imag() - vi);
+                a = std::complex<float>(a.real() + vr, a.imag() + vi);
+            }
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#include <complex>
+#include <vector>
+#pragma once
+
+// Radix-2 complex FFT plan with precomputed twiddle factors and bit-reversal table.
+// A plan is built once for a given power-of-two size and can be reused for any number of transforms.
+class FFT
+{
+public:
+    explicit FFT(int size);
+    int size() const;
+
+    // In-place transforms; inverse() is scaled by 1/size so that inverse(forward(x)) == x
+    void forward(std::complex<float> *data) const;
+    void inverse(std::complex<float> *data) const;
+
+    // Smallest power of two that is >= n
+    static int nextPowerOfTwo(int n);
+
+private:
+    void transform(std::complex<float> *data, bool invert) const;
+
+    int n;
+    std::vector<int> bitReverse;
+    std::vector<std::complex<float>> twiddles;
+};
@@ -1,67 +1,341 @@
 #include "frequency_detector.h"
-#define PI 3.14159265358979323846
+#include "autocorrelation_detector.h"
+#include "yin_detector.h"
+#include "mcleod_detector.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <chrono>
 
-// Constructor: initialize sample rate
+// In auto string mode a string's peak must reach this fraction of the strongest one to be chosen
+#define STRING_PEAK_THRESHOLD 0.9f
+
+// Constructor: initialize sample rate; derived engines call configure() once constructed
 FrequencyDetector::FrequencyDetector(float sampleRate)
     : sampleRate(sampleRate) {}
 
+std::unique_ptr<FrequencyDetector> FrequencyDetector::create(PitchEngine engine, float sampleRate, int maxFrameSize)
+{
+    switch (engine)
+    {
+    case PitchEngine::YIN:
+        return std::unique_ptr<FrequencyDetector>(new YinDetector(sampleRate, maxFrameSize));
+    case PitchEngine::McLeod:
+        return std::unique_ptr<FrequencyDetector>(new McLeodDetector(sampleRate, maxFrameSize));
+    case PitchEngine::Autocorrelation:
+    default:
+        return std::unique_ptr<FrequencyDetector>(new AutocorrelationDetector(sampleRate, maxFrameSize));
+    }
+}
+
+const char *FrequencyDetector::engineName(PitchEngine engine)
+{
+    switch (engine)
+    {
+    case PitchEngine::YIN:
+        return "YIN";
+    case PitchEngine::McLeod:
+        return "McLeod";
+    case PitchEngine::Autocorrelation:
+    default:
+        return "Autocorrelation";
+    }
+}
+
+void FrequencyDetector::configure(int frameSize)
+{
+    maxFrameSize = frameSize;
+    correlation.assign(maxFrameSize, 0.0f);
+    energyPrefix.assign(maxFrameSize + 1, 0.0);
+    score.assign(maxFrameSize, 0.0f);
+    bank.configure(maxFrameSize);
+
+    // Lags never exceed the frame length, so 2 * maxFrameSize is always enough zero padding
+    int fftSize = FFT::nextPowerOfTwo(2 * maxFrameSize);
+    fftPlan.reset(new FFT(fftSize));
+    spectrum.assign(fftSize, std::complex<float>(0.0f, 0.0f));
+
+    allocate(maxFrameSize);
+}
+
+int FrequencyDetector::getMaxFrameSize() const
+{
+    return maxFrameSize;
+}
+
+void FrequencyDetector::prepareFrameSize(int size)
+{
+    if (size >= 2)
+        prepare(std::min(size, maxFrameSize));
+}
+
+void FrequencyDetector::prepare(int) {}
+
 // Set the frequency we want to match
 void FrequencyDetector::setTarget(float freq)
 {
     targetFreq = freq;
+    mode = freq > 0.0f ? DetectionMode::Target : DetectionMode::Chromatic;
+    if (mode == DetectionMode::Target)
+        bank.setTarget(freq, sampleRate);
 }
 
-// Detect the dominant frequency in the given audio buffer
-float FrequencyDetector::detect(const float *input, int size)
+void FrequencyDetector::setTargetSearch(TargetSearch search)
 {
-    
-    //Hann windowing to reduce spectral leakage
-    std::vector<float> windowed(size);
-    for (int i = 0; i < size; ++i)
+    targetSearch = search;
+}
+
+TargetSearch FrequencyDetector::getTargetSearch() const
+{
+    return targetSearch;
+}
+
+void FrequencyDetector::setChromatic()
+{
+    targetFreq = 0.0f;
+    mode = DetectionMode::Chromatic;
+}
+
+bool FrequencyDetector::isChromatic() const
+{
+    return mode == DetectionMode::Chromatic;
+}
+
+DetectionMode FrequencyDetector::getMode() const
+{
+    return mode;
+}
+
+void FrequencyDetector::setStrings(const float *freqs, int count)
+{
+    stringCount = std::min(count, MAX_STRINGS);
+    targetFreq = 0.0f;
+    mode = DetectionMode::Strings;
+
+    for (int s = 0; s < stringCount; ++s)
     {
-        float window = 0.5f * (1 - std::cos(2 * PI * i / (size - 1)));
-        windowed[i] = input[i] * window;
+        // Nearest lower and higher strings; the band edge is their geometric midpoint
+        float lower = 0.0f, higher = 0.0f;
+        for (int o = 0; o < stringCount; ++o)
+        {
+            if (o == s)
+                continue;
+            if (freqs[o] < freqs[s] && freqs[o] > lower)
+                lower = freqs[o];
+            if (freqs[o] > freqs[s] && (higher == 0.0f || freqs[o] < higher))
+                higher = freqs[o];
+        }
+
+        // Outermost strings mirror the gap to their only neighbour, at least one semitone
+        const float semitone = std::pow(2.0f, 1.0f / 12.0f);
+        float upRatio = higher > 0.0f ? std::sqrt(higher / freqs[s]) : 0.0f;
+        float downRatio = lower > 0.0f ? std::sqrt(freqs[s] / lower) : 0.0f;
+        if (upRatio == 0.0f)
+            upRatio = std::max(semitone, downRatio);
+        if (downRatio == 0.0f)
+            downRatio = std::max(semitone, upRatio);
+
+        stringMinLag[s] = static_cast<int>(std::ceil(sampleRate / (freqs[s] * upRatio)));
+        stringMaxLag[s] = static_cast<int>(sampleRate / (freqs[s] / downRatio));
     }
+}
 
-    int minLag = sampleRate / (targetFreq * 1.5f);
-    int maxLag = sampleRate / (targetFreq / 1.5f);
+void FrequencyDetector::setCorrelationMethod(CorrelationMethod m)
+{
+    method = m;
+}
 
-    // Autocorrelation to find periodicity
-    float maxCorr = 0;
-    int bestLag = -1;
-    for (int lag = minLag; lag <= maxLag; ++lag)
+CorrelationMethod FrequencyDetector::getCorrelationMethod() const
+{
+    return method;
+}
+
+double FrequencyDetector::getLastAnalysisMicros() const
+{
+    return lastAnalysisMicros;
+}
+
+// Analyze the given audio buffer with the engine and time it
+PitchResult FrequencyDetector::analyze(const float *input, int size, const float *precomputed)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (size > maxFrameSize)
+        size = maxFrameSize;
+
+    PitchResult result;
+    externalCorrelation = usesRawCorrelation() ? precomputed : nullptr;
+    if (size >= 2)
     {
-        float sum = 0;
-        for (int i = 0; i < size - lag; ++i)
-            sum += windowed[i] * windowed[i + lag];
+        if (mode == DetectionMode::Strings)
+            result = estimateStrings(input, size);
+        else if (mode == DetectionMode::Target && targetSearch == TargetSearch::FilterBank)
+            result = bank.estimate(input, size);
+        else
+            result = estimate(input, size);
+    }
+    externalCorrelation = nullptr;
+
+    lastAnalysisMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Detect the dominant frequency in the given audio buffer
+float FrequencyDetector::detect(const float *input, int size)
+{
+    return analyze(input, size).frequency;
+}
+
+bool FrequencyDetector::usesRawCorrelation() const
+{
+    return false;
+}
+
+int FrequencyDetector::correlationLength(int size) const
+{
+    if (size > maxFrameSize)
+        size = maxFrameSize;
+
+    // The filter bank works on the samples, not on lags
+    if (mode == DetectionMode::Target && targetSearch == TargetSearch::FilterBank)
+        return 0;
+
+    int minLag, maxLag;
+    return searchRange(size, minLag, maxLag) ? maxLag + 2 : 0;
+}
 
-        if (sum > maxCorr)
+bool FrequencyDetector::searchRange(int size, int &minLag, int &maxLag) const
+{
+    if (mode == DetectionMode::Chromatic || mode == DetectionMode::Strings)
+    {
+        minLag = static_cast<int>(sampleRate / MAX_DETECT_FREQ);
+        maxLag = static_cast<int>(sampleRate / MIN_DETECT_FREQ);
+        if (mode == DetectionMode::Strings && stringCount > 0)
         {
-            maxCorr = sum;
-            bestLag = lag;
+            minLag = *std::min_element(stringMinLag, stringMinLag + stringCount);
+            maxLag = *std::max_element(stringMaxLag, stringMaxLag + stringCount);
         }
+        if (maxLag > longestLag(size))
+            maxLag = longestLag(size);
+    }
+    else
+    {
+        minLag = sampleRate / (targetFreq * 1.5f);
+        maxLag = sampleRate / (targetFreq / 1.5f);
+        if (maxLag > size - 2)
+            maxLag = size - 2;
     }
 
-    // No valid lag found
-    if (bestLag <= 0)
-        return 0.0f;
+    if (minLag < 2)
+        minLag = 2;
+    return maxLag > minLag + 2;
+}
 
-    // Estimate frequency from lag
-    float freq = sampleRate / bestLag;
+// The periodicity function is computed once over the union of all string bands; each string is
+// then represented by its best local maximum inside its own band
+PitchResult FrequencyDetector::estimateStrings(const float *input, int size)
+{
+    PitchResult result;
+    int minLag, maxLag;
+    if (stringCount == 0 || !searchRange(size, minLag, maxLag) || !periodicity(input, size, minLag, maxLag))
+        return result;
 
-    // Fold down harmonics
-    float bestFreq = freq;
-    float bestDiff = std::abs(freq - targetFreq);
-    for (int d = 2; d <= 6; ++d)
+    int peaks[MAX_STRINGS];
+    float strongest = 0.0f;
+    for (int s = 0; s < stringCount; ++s)
     {
-        float f = freq / d;
-        float diff = std::abs(f - targetFreq);
-        if (diff < bestDiff && f > 20.0f)
+        peaks[s] = -1;
+        int lo = std::max(minLag, stringMinLag[s]);
+        int hi = std::min(maxLag, stringMaxLag[s]);
+        for (int lag = lo; lag <= hi; ++lag)
         {
-            bestFreq = f;
-            bestDiff = diff;
+            if (score[lag] > 0.0f && score[lag] >= score[lag - 1] && score[lag] > score[lag + 1] &&
+                (peaks[s] < 0 || score[lag] > score[peaks[s]]))
+                peaks[s] = lag;
         }
+        if (peaks[s] >= 0)
+            strongest = std::max(strongest, score[peaks[s]]);
+    }
+
+    // A lower string's band also holds multiples of a higher string's period, so prefer the
+    // highest string whose peak is nearly as strong as the best one
+    int best = -1;
+    for (int s = 0; s < stringCount; ++s)
+    {
+        if (peaks[s] >= 0 && score[peaks[s]] >= STRING_PEAK_THRESHOLD * strongest && (best < 0 || peaks[s] < peaks[best]))
+            best = s;
     }
+    if (best < 0)
+        return result;
 
-    return bestFreq;
+    int lag = peaks[best];
+    float period = lag + parabolicOffset(score[lag - 1], score[lag], score[lag + 1]);
+    result.frequency = sampleRate / period;
+    result.confidence = std::max(0.0f, std::min(1.0f, score[lag]));
+    result.stringIndex = best;
+    return result;
+}
+
+// Plain autocorrelation needs about two periods in the frame to see a clear peak
+int FrequencyDetector::longestLag(int size) const
+{
+    return size / 2;
+}
+
+void FrequencyDetector::computeCorrelation(const float *frame, int size, int minLag, int maxLag)
+{
+    if (externalCorrelation)
+    {
+        for (int lag = minLag; lag <= maxLag; ++lag)
+            correlation[lag] = externalCorrelation[lag];
+        return;
+    }
+
+    if (method == CorrelationMethod::FFT)
+        computeCorrelationFFT(frame, size, maxLag);
+    else
+        computeCorrelationDirect(frame, size, minLag, maxLag);
+}
+
+// Legacy path: one inner product per lag, vectorized for the CPU we run on
+void FrequencyDetector::computeCorrelationDirect(const float *frame, int size, int minLag, int maxLag)
+{
+    const SimdKernels &kernels = activeKernels();
+    for (int lag = minLag; lag <= maxLag; ++lag)
+        correlation[lag] = kernels.dot(frame, frame + lag, size - lag);
+}
+
+// Wiener-Khinchin: r = IFFT(|FFT(x)|^2). The plan length is at least twice the frame
+// so the circular correlation does not wrap around into the lags we read back.
+void FrequencyDetector::computeCorrelationFFT(const float *frame, int size, int maxLag)
+{
+    int fftSize = fftPlan->size();
+
+    for (int i = 0; i < size; ++i)
+        spectrum[i] = std::complex<float>(frame[i], 0.0f);
+    for (int i = size; i < fftSize; ++i)
+        spectrum[i] = std::complex<float>(0.0f, 0.0f);
+
+    fftPlan->forward(spectrum.data());
+    for (int i = 0; i < fftSize; ++i)
+        spectrum[i] = std::complex<float>(std::norm(spectrum[i]), 0.0f);
+    fftPlan->inverse(spectrum.data());
+
+    for (int lag = 0; lag <= maxLag; ++lag)
+        correlation[lag] = spectrum[lag].real();
+}
+
+void FrequencyDetector::computeEnergyPrefix(const float *frame, int size)
+{
+    energyPrefix[0] = 0.0;
+    for (int i = 0; i < size; ++i)
+        energyPrefix[i + 1] = energyPrefix[i] + static_cast<double>(frame[i]) * frame[i];
+}
+
+float FrequencyDetector::parabolicOffset(float left, float centre, float right)
+{
+    float denom = left - 2.0f * centre + right;
+    if (denom == 0.0f)
+        return 0.0f;
+    float offset = 0.5f * (left - right) / denom;
+    return std::max(-0.5f, std::min(0.5f, offset));
 }
@@ -1,16 +1,170 @@
 #include <cmath>
+#include <complex>
+#include <memory>
 #include <vector>
+#include "fft.h"
+#include "goertzel_bank.h"
 #pragma once
 
-// Class to detect the fundamental frequency of an audio signal
+// Pitch range accepted by the tuner and searched in chromatic mode
+#define MIN_DETECT_FREQ 20.0f
+#define MAX_DETECT_FREQ 1500.0f
+
+// Most strings an auto string mode tuning may have
+#define MAX_STRINGS 12
+
+// How the autocorrelation is computed
+enum class CorrelationMethod
+{
+    Direct, // O(N*L) loop over every lag in the search window (legacy, kept for validation)
+    FFT     // Wiener-Khinchin: inverse FFT of the power spectrum, O(N log N) for all lags at once
+};
+
+// Available pitch estimation engines
+enum class PitchEngine
+{
+    Autocorrelation, // Hann-windowed autocorrelation peak picking
+    YIN,             // cumulative mean normalized difference function (de Cheveigne & Kawahara)
+    McLeod           // normalized square difference function, MPM (McLeod & Wyvill)
+};
+
+// Result of one analysis: 0 Hz means no pitch was found
+struct PitchResult
+{
+    float frequency = 0.0f;
+    float confidence = 0.0f; // 0..1, engine-specific periodicity measure
+    int stringIndex = -1;    // auto string mode: index of the detected string in the tuning
+};
+
+// How target mode looks for the target
+enum class TargetSearch
+{
+    Lags,      // the engine's own search over lags within +-1.5x of the target
+    FilterBank // Goertzel bank a few semitones around the target and its harmonics, phase-refined
+};
+
+// What the detector is searching for
+enum class DetectionMode
+{
+    Target,    // one preselected frequency, +-1.5x
+    Chromatic, // anything in MIN_DETECT_FREQ..MAX_DETECT_FREQ
+    Strings    // whichever string of a tuning is being played
+};
+
+// Interface for detectors of the fundamental frequency of an audio signal.
+// All buffers (scratch, FFT plan, engine tables) are allocated up front for the maximum frame size,
+// so analyze() performs no heap allocations and no transcendental calls per frame (bar the one atan2
+// of the filter bank's phase refinement).
 class FrequencyDetector
 {
 public:
-    FrequencyDetector(float sampleRate);
+    virtual ~FrequencyDetector() = default;
+
+    static std::unique_ptr<FrequencyDetector> create(PitchEngine engine, float sampleRate, int maxFrameSize);
+    static const char *engineName(PitchEngine engine);
+    virtual PitchEngine getEngine() const = 0;
+
+    // (Re)allocate the workspace for a new maximum frame size. Not real-time safe.
+    void configure(int maxFrameSize);
+    int getMaxFrameSize() const;
+
+    // Precompute the size-dependent tables for frames of this size, so analyze() finds them ready
+    // when the caller switches to it. The maximum frame size is always prepared; sizes nobody prepared
+    // still work but are rebuilt on first use. Call after configure(). Not real-time safe.
+    void prepareFrameSize(int size);
+
+    // Target mode; with TargetSearch::FilterBank this also precomputes the bank's coefficients
     void setTarget(float freq);
+
+    // Engine-independent: in target mode the filter bank replaces the engine's estimate
+    void setTargetSearch(TargetSearch search);
+    TargetSearch getTargetSearch() const;
+
+    // Chromatic mode: no target, search the full MIN_DETECT_FREQ..MAX_DETECT_FREQ range
+    void setChromatic();
+    bool isChromatic() const;
+
+    // Auto string mode: one periodicity function per frame is scored against every string's lag band
+    // (split halfway, in pitch, between neighbouring strings) and the played string is reported in
+    // PitchResult::stringIndex. At most MAX_STRINGS frequencies, in any order. Not real-time safe.
+    void setStrings(const float *freqs, int count);
+    DetectionMode getMode() const;
+
+    // Frames longer than the configured maximum are truncated to it.
+    // Engines that use the raw frame's autocorrelation (usesRawCorrelation()) can be handed one that was
+    // maintained elsewhere, e.g. updated incrementally by StreamingAnalyzer; it must hold lags
+    // [0, correlationLength(size)). Other engines ignore it.
+    PitchResult analyze(const float *input, int size, const float *precomputed = nullptr);
     float detect(const float *input, int size);
 
-private:
+    virtual bool usesRawCorrelation() const;
+
+    // Number of autocorrelation lags the current mode needs for a frame of the given size (0 if none)
+    int correlationLength(int size) const;
+
+    void setCorrelationMethod(CorrelationMethod method);
+    CorrelationMethod getCorrelationMethod() const;
+
+    // Wall-clock time spent in the last call to analyze(), in microseconds
+    double getLastAnalysisMicros() const;
+
+protected:
+    FrequencyDetector(float sampleRate);
+
+    // Engine-specific workspace allocation, called from configure()
+    virtual void allocate(int maxFrameSize) = 0;
+    // Engine-specific per-size tables, called from prepareFrameSize() with size <= maxFrameSize
+    virtual void prepare(int size);
+    virtual PitchResult estimate(const float *input, int size) = 0;
+
+    // Fill score[lag] for lags [minLag - 1, maxLag + 1] with the engine's periodicity measure,
+    // higher is more periodic and about 1 for a clean period. Returns false on silence.
+    virtual bool periodicity(const float *input, int size, int minLag, int maxLag) = 0;
+
+    // Lag window for the current mode: +-1.5x around the target, the full range in chromatic mode
+    // or the union of the string bands (both capped to longestLag()). Returns false if it is empty.
+    bool searchRange(int size, int &minLag, int &maxLag) const;
+
+    // Longest lag the engine can judge reliably in a frame of the given size
+    virtual int longestLag(int size) const;
+
+    // Fill correlation[lag] for every lag in [minLag, maxLag] using the selected method,
+    // or copy them from the caller-supplied correlation when one was passed to analyze()
+    void computeCorrelation(const float *frame, int size, int minLag, int maxLag);
+    void computeCorrelationDirect(const float *frame, int size, int minLag, int maxLag);
+    void computeCorrelationFFT(const float *frame, int size, int maxLag);
+
+    // energyPrefix[k] = sum of frame[i]^2 for i < k, so any window energy is one subtraction
+    void computeEnergyPrefix(const float *frame, int size);
+
+    // Vertex of the parabola through three equally spaced points, relative to the middle one
+    static float parabolicOffset(float left, float centre, float right);
+
     float sampleRate;
     float targetFreq = 0.0f;
-};
\ No newline at end of file
+    DetectionMode mode = DetectionMode::Chromatic;
+    TargetSearch targetSearch = TargetSearch::Lags;
+    CorrelationMethod method = CorrelationMethod::Direct;
+    int maxFrameSize = 0;
+    std::vector<float> correlation;
+    std::vector<double> energyPrefix;
+    std::vector<float> score;
+
+private:
+    // Auto string mode: pick the played string from the shared periodicity function
+    PitchResult estimateStrings(const float *input, int size);
+
+    double lastAnalysisMicros = 0.0;
+
+    int stringCount = 0;
+    int stringMinLag[MAX_STRINGS];
+    int stringMaxLag[MAX_STRINGS];
+
+    const float *externalCorrelation = nullptr;
+
+    GoertzelBank bank;
+
+    // Single plan sized for the largest frame; smaller frames are simply zero-padded further
+    std::unique_ptr<FFT> fftPlan;
+    std::vector<std::complex<float>> spectrum;
+};
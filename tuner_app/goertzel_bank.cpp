@@ -0,0 +1,178 @@
+#include "goertzel_bank.h"
+#include "frequency_detector.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#define PI 3.14159265358979323846
+
+GoertzelBank::GoertzelBank() : decimator(0)
+{
+    for (int b = 0; b < PADDED_BINS; ++b)
+    {
+        frequencies[b] = 0.0f;
+        coefficients[b] = 0.0f;
+        cosines[b] = 1.0f;
+        sines[b] = 0.0f;
+        active[b] = false;
+    }
+    for (int c = 0; c < CANDIDATES; ++c)
+    {
+        rotationCos[c] = 1.0f;
+        rotationSin[c] = 0.0f;
+    }
+}
+
+void GoertzelBank::configure(int maxFrameSize)
+{
+    decimator.configure(maxFrameSize);
+    decimated.assign(maxFrameSize, 0.0f);
+    window.assign(maxFrameSize, 0.0f);
+    segmentWindow.assign(maxFrameSize, 0.0f);
+    windowed.assign(maxFrameSize, 0.0f);
+    segment.assign(maxFrameSize, 0.0f);
+    windowSize = 0;
+}
+
+void GoertzelBank::setTarget(float freq, float rate)
+{
+    // Only the highest bin has to survive decimation
+    float highest = freq * std::pow(2.0f, SPAN_STEPS * STEP_SEMITONES / 12.0f) * HARMONICS;
+    factor = HalfBandDecimator::chooseFactor(rate, highest, 1);
+    sampleRate = rate / factor;
+    target = freq;
+    windowSize = 0;
+
+    for (int c = 0; c < CANDIDATES; ++c)
+    {
+        float fundamental = freq * std::pow(2.0f, (c - SPAN_STEPS) * STEP_SEMITONES / 12.0f);
+        for (int h = 0; h < HARMONICS; ++h)
+        {
+            int b = c * HARMONICS + h;
+            double w = 2.0 * PI * fundamental * (h + 1) / sampleRate;
+            frequencies[b] = fundamental * (h + 1);
+            active[b] = frequencies[b] < 0.5f * sampleRate;
+            cosines[b] = static_cast<float>(std::cos(w));
+            sines[b] = static_cast<float>(std::sin(w));
+            coefficients[b] = 2.0f * cosines[b];
+        }
+    }
+}
+
+void GoertzelBank::buildWindows(int size)
+{
+    windowSize = size;
+    shift = size / 4;
+    int length = size - shift;
+
+    windowSum = 0.0f;
+    for (int i = 0; i < size; ++i)
+    {
+        window[i] = 0.5f * (1 - std::cos(2 * PI * i / (size - 1)));
+        windowSum += window[i];
+    }
+    for (int i = 0; i < length; ++i)
+        segmentWindow[i] = 0.5f * (1 - std::cos(2 * PI * i / (length - 1)));
+
+    // A partial exactly at a candidate advances its phase by w * shift between the two segments
+    for (int c = 0; c < CANDIDATES; ++c)
+    {
+        double advance = 2.0 * PI * frequencies[c * HARMONICS] / sampleRate * shift;
+        rotationCos[c] = static_cast<float>(std::cos(advance));
+        rotationSin[c] = static_cast<float>(std::sin(advance));
+    }
+}
+
+void GoertzelBank::goertzel(const float *frame, int length, float cosine, float sine, float &re, float &im) const
+{
+    float coefficient = 2.0f * cosine;
+    float s1 = 0.0f, s2 = 0.0f;
+    for (int i = 0; i < length; ++i)
+    {
+        float s0 = frame[i] + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    re = s1 - cosine * s2;
+    im = sine * s2;
+}
+
+PitchResult GoertzelBank::estimate(const float *input, int size)
+{
+    PitchResult result;
+    if (target <= 0.0f)
+        return result;
+
+    const SimdKernels &kernels = activeKernels();
+    float energy = kernels.sumSquares(input, size);
+    if (energy <= 0.0f)
+        return result;
+    float meanPower = energy / size;
+
+    size = decimator.process(input, size, factor, decimated.data());
+    if (size < 8)
+        return result;
+    if (size != windowSize)
+        buildWindows(size);
+    input = decimated.data();
+    kernels.multiply(input, window.data(), windowed.data(), size);
+
+    // Run every bin side by side: one multiply-add per bin and sample, independent across bins
+    float s1[PADDED_BINS] = {}, s2[PADDED_BINS] = {};
+    for (int i = 0; i < size; ++i)
+    {
+        float x = windowed[i];
+        for (int b = 0; b < PADDED_BINS; ++b)
+        {
+            float s0 = x + coefficients[b] * s1[b] - s2[b];
+            s2[b] = s1[b];
+            s1[b] = s0;
+        }
+    }
+
+    // Candidate score: power summed over its partials
+    int best = -1;
+    float bestScore = 0.0f;
+    for (int c = 0; c < CANDIDATES; ++c)
+    {
+        float score = 0.0f;
+        for (int h = 0; h < HARMONICS; ++h)
+        {
+            int b = c * HARMONICS + h;
+            if (active[b])
+                score += s1[b] * s1[b] + s2[b] * s2[b] - coefficients[b] * s1[b] * s2[b];
+        }
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = c;
+        }
+    }
+    if (best < 0)
+        return result;
+
+    // Phase refinement on the fundamental: compare its bin over [0, length) and [shift, shift + length)
+    int b = best * HARMONICS;
+    int length = size - shift;
+    float reA, imA, reB, imB;
+    kernels.multiply(input, segmentWindow.data(), segment.data(), length);
+    goertzel(segment.data(), length, cosines[b], sines[b], reA, imA);
+    kernels.multiply(input + shift, segmentWindow.data(), segment.data(), length);
+    goertzel(segment.data(), length, cosines[b], sines[b], reB, imB);
+
+    // z = B * conj(A) * e^(-j w shift): what is left is the drift away from the candidate
+    float re = reB * reA + imB * imA;
+    float im = imB * reA - reB * imA;
+    float driftRe = re * rotationCos[best] + im * rotationSin[best];
+    float driftIm = im * rotationCos[best] - re * rotationSin[best];
+    if (driftRe == 0.0f && driftIm == 0.0f)
+        return result;
+    float drift = std::atan2(driftIm, driftRe);
+
+    // A Hann-windowed partial of amplitude A gives |X| = A * windowSum / 2, power A^2 / 2
+    float amplitudeScale = 2.0f / windowSum;
+    float partialPower = 0.5f * bestScore * amplitudeScale * amplitudeScale;
+
+    result.frequency = frequencies[b] + static_cast<float>(drift * sampleRate / (2.0 * PI * shift));
+    result.confidence = std::min(1.0f, partialPower / meanPower);
+    return result;
+}
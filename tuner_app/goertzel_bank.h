@@ -0,0 +1,64 @@
+#include "decimator.h"
+#include <vector>
+#pragma once
+
+struct PitchResult;
+
+// Narrow-band analysis around a known target: a bank of Goertzel filters at candidate fundamentals
+// a few semitones either side of the target, each scored together with its first harmonics.
+// The best candidate is refined from the phase advance of its bin between two overlapping segments
+// of the frame, which resolves far finer than the bin spacing. The frame is first decimated as far
+// as the highest bin allows, and all coefficients are computed in setTarget(); estimate() then
+// costs one second-order recursion per bin and decimated sample.
+class GoertzelBank
+{
+public:
+    static constexpr int SPAN_STEPS = 12;      // candidates either side of the target
+    static constexpr float STEP_SEMITONES = 0.25f;
+    static constexpr int HARMONICS = 3;        // partials scored per candidate, fundamental included
+    static constexpr int CANDIDATES = 2 * SPAN_STEPS + 1;
+    static constexpr int BINS = CANDIDATES * HARMONICS;
+    static constexpr int PADDED_BINS = (BINS + 15) / 16 * 16; // whole vectors for the bin loop
+
+    GoertzelBank();
+
+    // (Re)allocate for a new maximum frame size. Not real-time safe.
+    void configure(int maxFrameSize);
+
+    // Precompute the bank for a target; harmonics above Nyquist are left out of the score
+    void setTarget(float freq, float sampleRate);
+
+    // Fundamental nearest the target, or 0 Hz; confidence is the fraction of the frame's power
+    // carried by the scored partials
+    PitchResult estimate(const float *input, int size);
+
+private:
+    // Hann windows for the whole frame and the two refinement segments, and the phase advance
+    // each candidate's fundamental is expected to show between the segments
+    void buildWindows(int size);
+
+    // Complex Goertzel output of one bin over frame[0, length)
+    void goertzel(const float *frame, int length, float cosine, float sine, float &re, float &im) const;
+
+    float sampleRate = 0.0f; // of the decimated frame
+    float target = 0.0f;
+    int factor = 1;
+    float frequencies[PADDED_BINS];
+    float coefficients[PADDED_BINS]; // 2 cos(w)
+    float cosines[PADDED_BINS];
+    float sines[PADDED_BINS];
+    bool active[PADDED_BINS];
+    float rotationCos[CANDIDATES];
+    float rotationSin[CANDIDATES];
+
+    HalfBandDecimator decimator;
+    std::vector<float> decimated;
+
+    int windowSize = 0;
+    int shift = 0; // offset of the second refinement segment
+    float windowSum = 0.0f;
+    std::vector<float> window;
+    std::vector<float> segmentWindow;
+    std::vector<float> windowed;
+    std::vector<float> segment;
+};
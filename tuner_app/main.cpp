@@ -1,9 +1,26 @@
 #include "tuner.h"
+#include <algorithm>
+#include <cstdlib>
 
-int main()
+// Usage: tuner [--headless name] [inputs [first input]], e.g. "tuner 6 0" tunes inputs 1-6 at once
+// and "tuner --headless tuner 6 0" publishes them to the shared-memory ring "tuner" instead
+int main(int argc, char *argv[])
 {
+    std::string ringName;
+    if (argc > 2 && std::string(argv[1]) == "--headless")
+    {
+        ringName = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    int channels = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1;
+    int firstChannel = argc > 2 ? std::max(0, std::atoi(argv[2])) : 1;
+
     std::cout << "Welcome to the Guitar Tuner App!\n";
-    GuitarTuner tuner;
-    tuner.run();
+    GuitarTuner tuner(channels, firstChannel);
+    if (ringName.empty())
+        tuner.run();
+    else
+        tuner.runHeadless(ringName);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,111 @@
+#include "mcleod_detector.h"
+#include <algorithm>
+
+// Fraction of the highest key maximum a peak must reach to be chosen (k in the MPM paper)
+#define MPM_CUTOFF 0.9f
+// Key maxima below this clarity are ignored
+#define MPM_SMALL_CUTOFF 0.5f
+
+McLeodDetector::McLeodDetector(float sampleRate, int maxFrameSize)
+    : FrequencyDetector(sampleRate)
+{
+    configure(maxFrameSize);
+}
+
+PitchEngine McLeodDetector::getEngine() const
+{
+    return PitchEngine::McLeod;
+}
+
+bool McLeodDetector::usesRawCorrelation() const
+{
+    return true;
+}
+
+void McLeodDetector::allocate(int frameSize)
+{
+    nsdf.assign(frameSize, 0.0f);
+}
+
+PitchResult McLeodDetector::estimate(const float *input, int size)
+{
+    PitchResult result;
+    int minLag, maxLag;
+    if (!searchRange(size, minLag, maxLag))
+        return result;
+
+    if (!computeNsdf(input, size, maxLag))
+        return result;
+
+    // Key maxima: the highest point of each positive lobe after the first negative-going zero crossing
+    int count = 0;
+    int lag = 1;
+    while (lag <= maxLag && nsdf[lag] > 0.0f)
+        ++lag;
+    while (lag <= maxLag && count < MAX_KEY_MAXIMA)
+    {
+        while (lag <= maxLag && nsdf[lag] <= 0.0f)
+            ++lag;
+
+        int peak = -1;
+        for (; lag <= maxLag && nsdf[lag] > 0.0f; ++lag)
+            if (lag >= minLag && (peak < 0 || nsdf[lag] > nsdf[peak]))
+                peak = lag;
+
+        if (peak > 0 && nsdf[peak] >= MPM_SMALL_CUTOFF)
+            keyMaxima[count++] = peak;
+    }
+
+    if (count == 0)
+        return result;
+
+    float highest = 0.0f;
+    for (int k = 0; k < count; ++k)
+        highest = std::max(highest, nsdf[keyMaxima[k]]);
+
+    int bestLag = keyMaxima[0];
+    for (int k = 0; k < count; ++k)
+    {
+        if (nsdf[keyMaxima[k]] >= MPM_CUTOFF * highest)
+        {
+            bestLag = keyMaxima[k];
+            break;
+        }
+    }
+
+    float left = nsdf[bestLag - 1], centre = nsdf[bestLag], right = nsdf[bestLag + 1];
+    float offset = parabolicOffset(left, centre, right);
+    result.frequency = sampleRate / (bestLag + offset);
+    result.confidence = std::min(1.0f, centre - 0.25f * (left - right) * offset);
+    return result;
+}
+
+bool McLeodDetector::periodicity(const float *input, int size, int minLag, int maxLag)
+{
+    if (!computeNsdf(input, size, maxLag))
+        return false;
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+        score[lag] = nsdf[lag];
+    return true;
+}
+
+bool McLeodDetector::computeNsdf(const float *input, int size, int maxLag)
+{
+    computeCorrelation(input, size, 0, maxLag + 1);
+    computeEnergyPrefix(input, size);
+    if (energyPrefix[size] <= 0.0)
+        return false;
+
+    for (int lag = 0; lag <= maxLag + 1; ++lag)
+    {
+        double m = energyPrefix[size - lag] + (energyPrefix[size] - energyPrefix[lag]);
+        nsdf[lag] = m > 0.0 ? static_cast<float>(2.0 * correlation[lag] / m) : 0.0f;
+    }
+    return true;
+}
+
+// The normalisation compensates for the shrinking overlap, so lags up to two thirds of the frame are usable
+int McLeodDetector::longestLag(int size) const
+{
+    return size * 2 / 3;
+}
@@ -0,0 +1,28 @@
+#include "frequency_detector.h"
+#pragma once
+
+// McLeod Pitch Method engine: normalized square difference function n(t) = 2 r(t) / m(t),
+// where m(t) comes from running energy sums. The first key maximum within a fraction of
+// the highest one is taken as the period, which avoids the octave errors of plain peak picking.
+class McLeodDetector : public FrequencyDetector
+{
+public:
+    McLeodDetector(float sampleRate, int maxFrameSize);
+    PitchEngine getEngine() const override;
+    bool usesRawCorrelation() const override;
+
+protected:
+    void allocate(int maxFrameSize) override;
+    PitchResult estimate(const float *input, int size) override;
+    bool periodicity(const float *input, int size, int minLag, int maxLag) override;
+    int longestLag(int size) const override;
+
+private:
+    static constexpr int MAX_KEY_MAXIMA = 32;
+
+    // Fill nsdf[0..maxLag + 1]; returns false if the frame is silent
+    bool computeNsdf(const float *input, int size, int maxLag);
+
+    std::vector<float> nsdf;
+    int keyMaxima[MAX_KEY_MAXIMA];
+};
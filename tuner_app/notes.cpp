@@ -0,0 +1,169 @@
+#include "notes.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Mantissa bits that index the log2 table; linear interpolation covers the rest
+#define LOG2_TABLE_BITS 8
+
+static const char *const NOTE_NAMES[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+static const char *const TEMPERAMENT_NAMES[TEMPERAMENT_COUNT] = {"equal", "Pythagorean", "just", "meantone",
+                                                                 "Werckmeister III"};
+
+// Deviation of each pitch class from equal temperament in cents, C first, tempered around C
+static constexpr double TEMPERAMENT_CENTS[TEMPERAMENT_COUNT][12] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 13.685, 3.910, -5.865, 7.820, -1.955, 11.730, 1.955, 15.640, 5.865, -3.910, 9.775},
+    {0, 11.731, 3.910, 15.641, -13.686, -1.955, -9.776, 1.955, 13.686, -15.641, 17.596, -11.731},
+    {0, -23.950, -6.843, 10.265, -13.686, 3.422, -20.529, -3.421, -27.373, -10.264, 6.843, -17.108},
+    {0, -9.775, -7.820, -5.865, -9.775, -1.955, -11.730, -3.910, -7.820, -11.730, -3.910, -7.820},
+};
+
+static constexpr double LN2 = 0.693147180559945309;
+
+// Compile-time exp and ln, by series that converge quickly over the ranges used below
+static constexpr double seriesExp(double x)
+{
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 30; ++n)
+    {
+        term *= x / n;
+        sum += term;
+    }
+    return sum;
+}
+
+// ln(y) = 2 atanh((y - 1) / (y + 1)), for y in [1, 2]
+static constexpr double seriesLog(double y)
+{
+    double z = (y - 1.0) / (y + 1.0);
+    double power = z, sum = 0.0;
+    for (int n = 1; n < 40; n += 2)
+    {
+        sum += power / n;
+        power *= z * z;
+    }
+    return 2.0 * sum;
+}
+
+// 2^(cents / 1200): whole octaves by doubling, the rest (under one octave) by the series
+static constexpr double centsRatio(double cents)
+{
+    double ratio = 1.0;
+    for (; cents >= 1200.0; cents -= 1200.0)
+        ratio *= 2.0;
+    for (; cents < 0.0; cents += 1200.0)
+        ratio *= 0.5;
+    return ratio * seriesExp(cents / 1200.0 * LN2);
+}
+
+struct NoteTables
+{
+    // Frequency of every MIDI note relative to A4, per temperament
+    float ratio[TEMPERAMENT_COUNT][128];
+    // Offset of each pitch class from its equal-tempered pitch in semitones, A = 0
+    float offset[TEMPERAMENT_COUNT][12];
+    // Where, in semitones above a pitch class, the next note becomes the nearer one: halfway between
+    // the two tempered pitches. Offsets stay within a third of a semitone, so this lies inside (0, 1).
+    float boundary[TEMPERAMENT_COUNT][12];
+    // log2(1 + i / 2^LOG2_TABLE_BITS), one extra entry for the interpolation
+    float log2[(1 << LOG2_TABLE_BITS) + 1];
+};
+
+static constexpr NoteTables makeTables()
+{
+    NoteTables t{};
+    for (int temperament = 0; temperament < TEMPERAMENT_COUNT; ++temperament)
+    {
+        const double *cents = TEMPERAMENT_CENTS[temperament];
+        for (int pc = 0; pc < 12; ++pc)
+        {
+            t.offset[temperament][pc] = static_cast<float>((cents[pc] - cents[9]) / 100.0);
+            t.boundary[temperament][pc] = static_cast<float>(0.5 + (cents[pc] + cents[(pc + 1) % 12] - 2.0 * cents[9]) / 200.0);
+        }
+        for (int midi = 0; midi < 128; ++midi)
+            t.ratio[temperament][midi] = static_cast<float>(centsRatio(100.0 * (midi - 69) + cents[midi % 12] - cents[9]));
+    }
+    for (int i = 0; i <= (1 << LOG2_TABLE_BITS); ++i)
+        t.log2[i] = static_cast<float>(seriesLog(1.0 + static_cast<double>(i) / (1 << LOG2_TABLE_BITS)) / LN2);
+    return t;
+}
+
+static constexpr NoteTables TABLES = makeTables();
+
+static_assert(TABLES.ratio[0][69] == 1.0f && TABLES.ratio[0][81] == 2.0f, "A must sit on the reference");
+static_assert(TABLES.log2[1 << LOG2_TABLE_BITS] == 1.0f, "log2 table must end at one octave");
+
+float fastLog2(float x)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>(bits >> 23) - 127;
+    std::uint32_t mantissa = bits & 0x7fffff;
+    std::uint32_t index = mantissa >> (23 - LOG2_TABLE_BITS);
+    float fraction = (mantissa & ((1u << (23 - LOG2_TABLE_BITS)) - 1)) * (1.0f / (1u << (23 - LOG2_TABLE_BITS)));
+    return exponent + TABLES.log2[index] + fraction * (TABLES.log2[index + 1] - TABLES.log2[index]);
+}
+
+NoteInfo nearestNote(float freq, float a4, Temperament temperament)
+{
+    const int t = static_cast<int>(temperament);
+    float semitones = 12.0f * fastLog2(freq / a4);
+
+    // Equal-tempered note at or below the input (truncation floors above MIDI 0, the clamp handles
+    // the rest), then one step up if the input is past the boundary to the next tempered note
+    int below = std::min(126, std::max(0, static_cast<int>(semitones + 69.0f)));
+    int midi = below + (semitones - (below - 69) >= TABLES.boundary[t][below % 12]);
+
+    NoteInfo note;
+    note.name = NOTE_NAMES[midi % 12];
+    note.octave = midi / 12 - 1;
+    note.midi = midi;
+    note.frequency = a4 * TABLES.ratio[t][midi];
+    note.cents = 100.0f * (semitones - (midi - 69) - TABLES.offset[t][midi % 12]);
+    return note;
+}
+
+float noteFrequency(int midi, float a4, Temperament temperament)
+{
+    return a4 * TABLES.ratio[static_cast<int>(temperament)][std::min(127, std::max(0, midi))];
+}
+
+const char *noteName(int midi)
+{
+    return NOTE_NAMES[((midi % 12) + 12) % 12];
+}
+
+int noteOctave(int midi)
+{
+    return midi / 12 - 1;
+}
+
+int parseNote(const char *text)
+{
+    static const int LETTER_CLASSES[7] = {9, 11, 0, 2, 4, 5, 7}; // A..G
+    char letter = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    if (letter < 'A' || letter > 'G')
+        return -1;
+    int pc = LETTER_CLASSES[letter - 'A'];
+
+    const char *rest = text + 1;
+    if (*rest == '#' || *rest == 'b' || *rest == 'B')
+    {
+        pc += *rest == '#' ? 1 : -1;
+        ++rest;
+    }
+
+    if (*rest == '\0' || !std::isdigit(static_cast<unsigned char>(*rest)) || rest[1] != '\0')
+        return -1;
+    int midi = (*rest - '0' + 1) * 12 + pc;
+    return midi >= 0 && midi < 128 ? midi : -1;
+}
+
+const char *temperamentName(Temperament temperament)
+{
+    return TEMPERAMENT_NAMES[static_cast<int>(temperament)];
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Nearest note for a detected frequency
+struct NoteInfo
+{
+    const char *name; // pitch class, e.g. "A" or "C#"
+    int octave;       // scientific pitch notation, A4 = 440 Hz
+    int midi;         // MIDI note number
+    float frequency;  // exact frequency of the note
+    float cents;      // offset of the input from the note, about -50..+50
+};
+
+// Tunings of the twelve notes. The alternate ones are tempered around C and shifted so that A
+// stays at the reference, which keeps A4 = 440 Hz meaningful for all of them.
+enum class Temperament
+{
+    Equal,        // 12-TET
+    Pythagorean,  // pure fifths, wolf between G# and D#
+    Just,         // 5-limit just intonation on C
+    Meantone,     // quarter-comma meantone: pure major thirds
+    Werckmeister  // Werckmeister III well temperament
+};
+
+#define TEMPERAMENT_COUNT 5
+
+// Most strings a named tuning has
+#define MAX_TUNING_STRINGS 8
+
+// A named instrument tuning, low string first
+struct Tuning
+{
+    const char *name;
+    int stringCount;
+    int midi[MAX_TUNING_STRINGS];
+};
+
+constexpr Tuning TUNINGS[] = {
+    {"Standard", 6, {40, 45, 50, 55, 59, 64}},            // E2 A2 D3 G3 B3 E4
+    {"Drop D", 6, {38, 45, 50, 55, 59, 64}},              // D2 A2 D3 G3 B3 E4
+    {"Half step down", 6, {39, 44, 49, 54, 58, 63}},      // D#2 G#2 C#3 F#3 A#3 D#4
+    {"DADGAD", 6, {38, 45, 50, 55, 57, 62}},              // D2 A2 D3 G3 A3 D4
+    {"Open G", 6, {38, 43, 50, 55, 59, 62}},              // D2 G2 D3 G3 B3 D4
+    {"Open D", 6, {38, 45, 50, 54, 57, 62}},              // D2 A2 D3 F#3 A3 D4
+    {"7-string", 7, {35, 40, 45, 50, 55, 59, 64}},        // B1 + standard
+    {"8-string", 8, {30, 35, 40, 45, 50, 55, 59, 64}},    // F#1 B1 + standard
+    {"Bass", 4, {28, 33, 38, 43}},                        // E1 A1 D2 G2
+    {"5-string bass", 5, {23, 28, 33, 38, 43}},           // B0 + bass
+};
+
+constexpr int TUNING_COUNT = sizeof(TUNINGS) / sizeof(TUNINGS[0]);
+
+// Map a frequency to its nearest note relative to the given A4 reference. Branch-free table
+// lookups only, cheap enough to run on every reading. freq must be positive.
+NoteInfo nearestNote(float freq, float a4 = 440.0f, Temperament temperament = Temperament::Equal);
+
+// Frequency of a MIDI note (0..127) relative to the given A4 reference
+float noteFrequency(int midi, float a4 = 440.0f, Temperament temperament = Temperament::Equal);
+
+// Pitch class name and octave of a MIDI note, e.g. "C#" and 3
+const char *noteName(int midi);
+int noteOctave(int midi);
+
+// MIDI note of a name like "E2", "F#3" or "Bb1" (any case), -1 if it is not one
+int parseNote(const char *text);
+
+const char *temperamentName(Temperament temperament);
+
+// log2 of a positive, normal float from a 256-entry table, within 0.005 cents of std::log2
+float fastLog2(float x);
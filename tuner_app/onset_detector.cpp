@@ -0,0 +1,59 @@
+#include "onset_detector.h"
+#include <algorithm>
+#include <cmath>
+
+// A block must carry this many times the background energy (6 dB) to be an attack
+#define RISE_RATIO 4.0f
+// Background level time constant: long against a block, short against a note's decay
+#define BACKGROUND_MS 30.0f
+// Pick noise and the first uneven cycles of a pluck
+#define SETTLE_MS 10.0f
+// A pluck's own energy swings within this time do not count as new onsets
+#define REFRACTORY_MS 60.0f
+
+OnsetDetector::OnsetDetector(float sampleRate)
+{
+    float blockMs = 1000.0f * BLOCK / sampleRate;
+    settleSamples = static_cast<int>(SETTLE_MS * sampleRate / 1000.0f);
+    refractoryBlocks = static_cast<int>(std::ceil(REFRACTORY_MS / blockMs));
+    smoothing = 1.0f - std::exp(-blockMs / BACKGROUND_MS);
+    reset();
+}
+
+void OnsetDetector::setSilenceThreshold(float rms)
+{
+    minEnergy = rms * rms;
+}
+
+void OnsetDetector::reset()
+{
+    energy = 0.0f;
+    count = 0;
+    background = 0.0f;
+    blocksSinceOnset = refractoryBlocks;
+}
+
+int OnsetDetector::getSettleSamples() const
+{
+    return settleSamples;
+}
+
+bool OnsetDetector::endBlock()
+{
+    float level = energy / BLOCK;
+    energy = 0.0f;
+    count = 0;
+
+    bool onset = blocksSinceOnset >= refractoryBlocks && level > minEnergy && level > RISE_RATIO * background;
+    if (onset)
+    {
+        // Start tracking the new note at its own level so its decay is not mistaken for anything
+        background = level;
+        blocksSinceOnset = 0;
+        return true;
+    }
+
+    background += smoothing * (level - background);
+    blocksSinceOnset = std::min(blocksSinceOnset + 1, refractoryBlocks);
+    return false;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Energy-flux onset detector for plucks. The input is cut into BLOCK-sample blocks; an onset fires
+// when a block's energy jumps RISE_RATIO above the slowly tracked background level (and above the
+// silence threshold), at most once per REFRACTORY_MS. Costs one multiply-add per sample.
+class OnsetDetector
+{
+public:
+    explicit OnsetDetector(float sampleRate);
+
+    // Blocks quieter than this RMS never count as an onset
+    void setSilenceThreshold(float rms);
+    void reset();
+
+    // Feed one sample; true on the sample that completes the block an attack was detected in
+    bool push(float x)
+    {
+        energy += x * x;
+        return ++count == BLOCK && endBlock();
+    }
+
+    // Samples after an onset that are still pick transient and are better left out of the analysis
+    int getSettleSamples() const;
+
+private:
+    static constexpr int BLOCK = 64;
+
+    bool endBlock();
+
+    int settleSamples;
+    int refractoryBlocks;
+    float minEnergy = 0.0f; // mean square of the silence threshold
+    float smoothing;        // one-pole coefficient of the background level, per block
+
+    float energy = 0.0f;
+    int count = 0;
+    float background = 0.0f;
+    int blocksSinceOnset = 0;
+};
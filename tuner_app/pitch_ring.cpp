@@ -0,0 +1,325 @@
+#include "pitch_ring.h"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define RING_MAGIC 0x474E5250u // "PRNG"
+#define RING_VERSION 1u
+
+// Segment layout: a 64-byte header, then per channel a 64-byte line holding the ring's head
+// followed by capacity 32-byte slots
+#define HEADER_BYTES 64
+#define HEAD_BYTES 64
+
+struct RingHeader
+{
+    std::atomic<std::uint32_t> magic; // stored last, once the rest is in place
+    std::uint32_t version;
+    std::uint32_t channels;
+    std::uint32_t capacity;
+};
+
+// A record as stored in a slot's payload words
+struct RingPayload
+{
+    std::int64_t timeNanos;
+    float frequency;
+    float confidence;
+    float cents;
+    std::int16_t midi;
+    std::uint8_t flags;
+    std::uint8_t reserved;
+};
+
+struct RingSlot
+{
+    std::atomic<std::uint64_t> sequence; // 2n+1 while record n is written, 2n+2 once it is complete
+    std::atomic<std::uint64_t> words[3];
+};
+
+static_assert(sizeof(RingHeader) <= HEADER_BYTES, "ring header must fit its line");
+static_assert(sizeof(RingPayload) == sizeof(RingSlot::words), "payload must fill the slot words");
+static_assert(sizeof(RingSlot) == 32, "slots are shared with other processes");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+static std::size_t channelBytes(std::uint32_t capacity)
+{
+    return HEAD_BYTES + static_cast<std::size_t>(capacity) * sizeof(RingSlot);
+}
+
+static std::size_t segmentBytes(int channels, std::uint32_t capacity)
+{
+    return HEADER_BYTES + channels * channelBytes(capacity);
+}
+
+static std::atomic<std::uint64_t> &ringHead(const std::uint8_t *base, int channel, std::uint32_t capacity)
+{
+    return *reinterpret_cast<std::atomic<std::uint64_t> *>(const_cast<std::uint8_t *>(base) + HEADER_BYTES +
+                                                           channel * channelBytes(capacity));
+}
+
+static RingSlot &ringSlot(const std::uint8_t *base, int channel, std::uint32_t capacity, std::uint64_t index)
+{
+    std::uint8_t *ring = const_cast<std::uint8_t *>(base) + HEADER_BYTES + channel * channelBytes(capacity) + HEAD_BYTES;
+    return reinterpret_cast<RingSlot *>(ring)[index & (capacity - 1)];
+}
+
+// Copy record index out of its slot; false if it is not there (torn, or already overwritten)
+static bool readSlot(const RingSlot &slot, std::uint64_t index, PitchSample &sample)
+{
+    std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * index + 2)
+        return false;
+    std::uint64_t words[3];
+    for (int i = 0; i < 3; ++i)
+        words[i] = slot.words[i].load(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before)
+        return false;
+
+    RingPayload payload;
+    std::memcpy(&payload, words, sizeof(payload));
+    sample.index = index;
+    sample.timeNanos = payload.timeNanos;
+    sample.frequency = payload.frequency;
+    sample.confidence = payload.confidence;
+    sample.cents = payload.cents;
+    sample.midi = payload.midi;
+    sample.flags = payload.flags;
+    return true;
+}
+
+#ifdef _WIN32
+static std::string segmentName(const std::string &name)
+{
+    return "Local\\" + (name.empty() || name[0] != '/' ? name : name.substr(1));
+}
+
+PitchRingWriter::PitchRingWriter(const std::string &name, int channels, int capacity)
+    : name(segmentName(name))
+{
+    for (this->capacity = 1; static_cast<int>(this->capacity) < capacity; this->capacity <<= 1)
+    {
+    }
+    length = segmentBytes(channels, this->capacity);
+
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(length >> 32),
+                                 static_cast<DWORD>(length & 0xFFFFFFFFu), this->name.c_str());
+    // A named mapping lives as long as any handle to it and cannot be replaced: if another tuner or
+    // a reader still holds one, CreateFileMapping hands back that segment, whatever its size, and
+    // zeroing it would pull the records out from under its readers
+    if (mapping && GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(mapping);
+        throw std::runtime_error("shared memory " + name + " is still in use");
+    }
+    if (mapping)
+        base = static_cast<std::uint8_t *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length));
+    if (!base)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        throw std::runtime_error("cannot create shared memory " + name);
+    }
+    std::memset(base, 0, length);
+
+    RingHeader *header = reinterpret_cast<RingHeader *>(base);
+    header->version = RING_VERSION;
+    header->channels = static_cast<std::uint32_t>(channels);
+    header->capacity = this->capacity;
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+}
+
+PitchRingWriter::~PitchRingWriter()
+{
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+}
+#else
+static std::string segmentName(const std::string &name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+PitchRingWriter::PitchRingWriter(const std::string &name, int channels, int capacity)
+    : name(segmentName(name))
+{
+    for (this->capacity = 1; static_cast<int>(this->capacity) < capacity; this->capacity <<= 1)
+    {
+    }
+    length = segmentBytes(channels, this->capacity);
+
+    // A segment left behind by a tuner that did not exit cleanly is replaced; readers still
+    // attached to it keep the old one
+    shm_unlink(this->name.c_str());
+    int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        throw std::runtime_error("cannot create shared memory " + name);
+    if (ftruncate(fd, static_cast<off_t>(length)) != 0)
+    {
+        close(fd);
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("cannot size shared memory " + name);
+    }
+    void *view = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("cannot map shared memory " + name);
+    }
+    base = static_cast<std::uint8_t *>(view);
+
+    // ftruncate zero-filled it: every head and sequence starts at 0
+    RingHeader *header = reinterpret_cast<RingHeader *>(base);
+    header->version = RING_VERSION;
+    header->channels = static_cast<std::uint32_t>(channels);
+    header->capacity = this->capacity;
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+}
+
+PitchRingWriter::~PitchRingWriter()
+{
+    munmap(base, length);
+    shm_unlink(name.c_str());
+}
+#endif
+
+PitchRingReader::PitchRingReader(const std::string &name)
+{
+#ifdef _WIN32
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, segmentName(name).c_str());
+    if (mapping)
+        base = static_cast<const std::uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!base)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        throw std::runtime_error("cannot open shared memory " + name);
+    }
+    MEMORY_BASIC_INFORMATION region;
+    VirtualQuery(base, &region, sizeof(region));
+    length = region.RegionSize;
+#else
+    int fd = shm_open(segmentName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        throw std::runtime_error("cannot open shared memory " + name);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < HEADER_BYTES)
+    {
+        close(fd);
+        throw std::runtime_error("invalid shared memory " + name);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    void *view = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        throw std::runtime_error("cannot map shared memory " + name);
+    base = static_cast<const std::uint8_t *>(view);
+#endif
+
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(base);
+    bool valid = header->magic.load(std::memory_order_acquire) == RING_MAGIC && header->version == RING_VERSION &&
+                 header->capacity > 0 && (header->capacity & (header->capacity - 1)) == 0 &&
+                 segmentBytes(header->channels, header->capacity) <= length;
+    if (!valid)
+    {
+        unmap();
+        throw std::runtime_error("not a pitch ring: " + name);
+    }
+
+    channels = static_cast<int>(header->channels);
+    capacity = header->capacity;
+    cursors.resize(channels);
+    lost.assign(channels, 0);
+    for (int c = 0; c < channels; ++c)
+        cursors[c] = ringHead(base, c, capacity).load(std::memory_order_acquire);
+}
+
+PitchRingReader::~PitchRingReader()
+{
+    unmap();
+}
+
+void PitchRingReader::unmap()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<std::uint8_t *>(base), length);
+#endif
+    base = nullptr;
+}
+
+void PitchRingWriter::publish(int channel, const PitchSample &sample)
+{
+    RingPayload payload = {};
+    payload.timeNanos = sample.timeNanos;
+    payload.frequency = sample.frequency;
+    payload.confidence = sample.confidence;
+    payload.cents = sample.cents;
+    payload.midi = static_cast<std::int16_t>(sample.midi);
+    payload.flags = static_cast<std::uint8_t>(sample.flags);
+    std::uint64_t words[3];
+    std::memcpy(words, &payload, sizeof(payload));
+
+    // Readers are never consulted: a slow one just finds its slots overwritten
+    std::atomic<std::uint64_t> &head = ringHead(base, channel, capacity);
+    std::uint64_t index = head.load(std::memory_order_relaxed);
+    RingSlot &slot = ringSlot(base, channel, capacity, index);
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    for (int i = 0; i < 3; ++i)
+        slot.words[i].store(words[i], std::memory_order_release);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+}
+
+int PitchRingReader::getChannelCount() const
+{
+    return channels;
+}
+
+bool PitchRingReader::next(int channel, PitchSample &sample)
+{
+    std::uint64_t head = ringHead(base, channel, capacity).load(std::memory_order_acquire);
+    std::uint64_t &cursor = cursors[channel];
+    while (cursor < head)
+    {
+        if (head - cursor > capacity)
+        {
+            lost[channel] += head - capacity - cursor;
+            cursor = head - capacity;
+        }
+        std::uint64_t index = cursor++;
+        if (readSlot(ringSlot(base, channel, capacity, index), index, sample))
+        {
+            sample.channel = channel;
+            return true;
+        }
+        ++lost[channel];
+    }
+    return false;
+}
+
+bool PitchRingReader::latest(int channel, PitchSample &sample) const
+{
+    std::uint64_t head = ringHead(base, channel, capacity).load(std::memory_order_acquire);
+    if (head == 0 || !readSlot(ringSlot(base, channel, capacity, head - 1), head - 1, sample))
+        return false;
+    sample.channel = channel;
+    return true;
+}
+
+std::uint64_t PitchRingReader::getLost(int channel) const
+{
+    return lost[channel];
+}
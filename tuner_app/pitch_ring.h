@@ -0,0 +1,91 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#pragma once
+
+// Flags of a published reading
+#define PITCH_ONSET 1 // first reading of a new note
+
+// One reading as published to other processes
+struct PitchSample
+{
+    std::uint64_t index = 0;     // position in the channel's stream, from 0
+    std::int64_t timeNanos = 0;  // steady clock (CLOCK_MONOTONIC on Linux) when its audio was captured
+    float frequency = 0.0f;      // Hz, 0 when no pitch was found
+    float confidence = 0.0f;     // 0..1
+    float cents = 0.0f;          // offset from the nearest note
+    int midi = -1;               // nearest note, -1 when no pitch was found
+    int channel = 0;
+    unsigned int flags = 0;      // PITCH_*
+};
+
+// Named shared-memory segment holding one ring of PitchSamples per input channel, so local processes
+// can follow the tuner without opening the audio device. Each ring has a single producer: the
+// channel's analysis worker publishes every reading with a few atomic stores and never looks at the
+// readers, so no reader can stall it. Every slot is a small seqlock: its sequence word is 2n+1 while
+// record n is written and 2n+2 once it is complete, and the ring's head counts the records
+// published. Readers map the segment read-only and copy records straight out of it; a torn or
+// overwritten slot is detected from its sequence and skipped. Throws std::runtime_error.
+class PitchRingWriter
+{
+public:
+    // Create the segment; capacity is rounded up to a power of two. On POSIX a segment of the same name
+    // is replaced. On Windows a named mapping cannot be, so this throws while any process, a reader
+    // included, still has one of that name open.
+    PitchRingWriter(const std::string &name, int channels, int capacity = 1024);
+    ~PitchRingWriter();
+
+    PitchRingWriter(const PitchRingWriter &) = delete;
+    PitchRingWriter &operator=(const PitchRingWriter &) = delete;
+
+    // Wait-free; one thread per channel. sample.index and sample.channel are ignored.
+    void publish(int channel, const PitchSample &sample);
+
+private:
+    std::string name;
+    std::uint8_t *base = nullptr;
+    std::size_t length = 0;
+    std::uint32_t capacity = 0;
+#ifdef _WIN32
+    void *mapping = nullptr;
+#endif
+};
+
+// Reader side; any number of them, in any process. Not thread-safe: one reader per thread.
+class PitchRingReader
+{
+public:
+    // Attach to a segment created by a PitchRingWriter; next() returns what is published from now on
+    explicit PitchRingReader(const std::string &name);
+    ~PitchRingReader();
+
+    PitchRingReader(const PitchRingReader &) = delete;
+    PitchRingReader &operator=(const PitchRingReader &) = delete;
+
+    int getChannelCount() const;
+
+    // Wait-free: the oldest record not read yet, false if there is none. A reader that falls more
+    // than a ring behind skips ahead to the oldest record still held.
+    bool next(int channel, PitchSample &sample);
+
+    // Wait-free: the newest record, false if there is none or the producer lapped the ring while
+    // it was being copied
+    bool latest(int channel, PitchSample &sample) const;
+
+    // Records this reader skipped because they were overwritten before it got to them
+    std::uint64_t getLost(int channel) const;
+
+private:
+    void unmap();
+
+    const std::uint8_t *base = nullptr;
+    std::size_t length = 0;
+    std::uint32_t capacity = 0;
+    int channels = 0;
+    std::vector<std::uint64_t> cursors;
+    std::vector<std::uint64_t> lost;
+#ifdef _WIN32
+    void *mapping = nullptr;
+#endif
+};
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#pragma once
+
+// Single-writer snapshot of a trivially copyable value. The writer never waits, so it may be an
+// analysis worker or the audio callback; readers retry while a store is in progress and always
+// get the newest complete value. The payload is kept in atomic words so concurrent copies are
+// well defined; their release stores and acquire loads order them against the sequence without
+// fences (free on x86, and visible to ThreadSanitizer).
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied bytewise");
+
+public:
+    Seqlock()
+    {
+        for (std::atomic<std::uint64_t> &word : words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    Seqlock(const Seqlock &) = delete;
+    Seqlock &operator=(const Seqlock &) = delete;
+
+    // Writer only
+    void store(const T &value)
+    {
+        std::uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        std::uint64_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        for (int i = 0; i < WORDS; ++i)
+            words[i].store(buffer[i], std::memory_order_release);
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Any thread: copy out the newest value and return its version, the number of stores so far
+    // (0 while nothing has been stored and value holds zero bytes)
+    std::uint64_t load(T &value) const
+    {
+        std::uint64_t buffer[WORDS];
+        while (true)
+        {
+            std::uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            for (int i = 0; i < WORDS; ++i)
+                buffer[i] = words[i].load(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+            {
+                std::memcpy(&value, buffer, sizeof(T));
+                return before / 2;
+            }
+        }
+    }
+
+    // Any thread: version of the newest complete value, without copying it
+    std::uint64_t version() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr int WORDS = static_cast<int>((sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+
+    alignas(64) std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> words[WORDS];
+};
@@ -0,0 +1,329 @@
+#include "simd_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC/Clang compile each kernel for its own ISA so the rest of the program keeps the baseline flags.
+// MSVC accepts the intrinsics without per-function flags.
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+// --- Scalar ---
+
+static float dotScalar(const float *a, const float *b, int n)
+{
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+static void multiplyScalar(const float *a, const float *b, float *out, int n)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+static float sumSquaresScalar(const float *a, int n)
+{
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * a[i];
+    return sum;
+}
+
+static void multiplyAddScalar(const float *a, float scale, float *out, int n)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] += scale * a[i];
+}
+
+#ifdef SIMD_X86
+
+// --- SSE2 ---
+
+TARGET_SSE2 static float horizontalSum(__m128 v)
+{
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+TARGET_SSE2 static float dotSSE2(const float *a, const float *b, int n)
+{
+    // Two accumulators hide the add latency
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float sum = horizontalSum(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+TARGET_SSE2 static void multiplySSE2(const float *a, const float *b, float *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+TARGET_SSE2 static float sumSquaresSSE2(const float *a, int n)
+{
+    return dotSSE2(a, a, n);
+}
+
+TARGET_SSE2 static void multiplyAddSSE2(const float *a, float scale, float *out, int n)
+{
+    __m128 s = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(s, _mm_loadu_ps(a + i))));
+    for (; i < n; ++i)
+        out[i] += scale * a[i];
+}
+
+// --- AVX2 + FMA ---
+
+TARGET_AVX2 static float horizontalSum(__m256 v)
+{
+    __m128 sums = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuffled = _mm_movehdup_ps(sums);
+    sums = _mm_add_ps(sums, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+TARGET_AVX2 static float dotAVX2(const float *a, const float *b, int n)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i + 8 <= n)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        i += 8;
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+TARGET_AVX2 static void multiplyAVX2(const float *a, const float *b, float *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+TARGET_AVX2 static float sumSquaresAVX2(const float *a, int n)
+{
+    return dotAVX2(a, a, n);
+}
+
+TARGET_AVX2 static void multiplyAddAVX2(const float *a, float scale, float *out, int n)
+{
+    __m256 s = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(s, _mm256_loadu_ps(a + i), _mm256_loadu_ps(out + i)));
+    for (; i < n; ++i)
+        out[i] += scale * a[i];
+}
+
+// --- AVX-512F ---
+
+TARGET_AVX512 static float dotAVX512(const float *a, const float *b, int n)
+{
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i < n; i += 16)
+    {
+        // Masked loads handle the tail without a scalar loop
+        __mmask16 mask = n - i >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc0);
+    }
+    // Reduce through memory: GCC 12's in-register reduction intrinsics trip -Wuninitialized
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float sum = 0;
+    for (int k = 0; k < 16; ++k)
+        sum += lanes[k];
+    return sum;
+}
+
+TARGET_AVX512 static void multiplyAVX512(const float *a, const float *b, float *out, int n)
+{
+    for (int i = 0; i < n; i += 16)
+    {
+        __mmask16 mask = n - i >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 product = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        _mm512_mask_storeu_ps(out + i, mask, product);
+    }
+}
+
+TARGET_AVX512 static float sumSquaresAVX512(const float *a, int n)
+{
+    return dotAVX512(a, a, n);
+}
+
+TARGET_AVX512 static void multiplyAddAVX512(const float *a, float scale, float *out, int n)
+{
+    __m512 s = _mm512_set1_ps(scale);
+    for (int i = 0; i < n; i += 16)
+    {
+        __mmask16 mask = n - i >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 sum = _mm512_fmadd_ps(s, _mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, out + i));
+        _mm512_mask_storeu_ps(out + i, mask, sum);
+    }
+}
+
+// --- CPU detection ---
+
+static void cpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; ++i)
+        regs[i] = static_cast<unsigned int>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register state the OS saves on context switch (XCR0)
+static unsigned long long enabledStateMask()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+
+#endif // SIMD_X86
+
+static const SimdKernels KERNELS[] = {
+    {SimdLevel::Scalar, dotScalar, multiplyScalar, sumSquaresScalar, multiplyAddScalar},
+#ifdef SIMD_X86
+    {SimdLevel::SSE2, dotSSE2, multiplySSE2, sumSquaresSSE2, multiplyAddSSE2},
+    {SimdLevel::AVX2, dotAVX2, multiplyAVX2, sumSquaresAVX2, multiplyAddAVX2},
+    {SimdLevel::AVX512, dotAVX512, multiplyAVX512, sumSquaresAVX512, multiplyAddAVX512},
+#endif
+};
+
+SimdLevel detectSimdLevel()
+{
+#ifdef SIMD_X86
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    bool sse2 = regs[3] & (1u << 26);
+    bool osxsave = regs[2] & (1u << 27);
+    bool avx = regs[2] & (1u << 28);
+    bool fma = regs[2] & (1u << 12);
+    if (!sse2)
+        return SimdLevel::Scalar;
+
+    bool avx2 = false, avx512 = false;
+    if (maxLeaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        avx2 = regs[1] & (1u << 5);
+        avx512 = regs[1] & (1u << 16);
+    }
+
+    // The OS must save YMM (bits 1-2) and, for AVX-512, opmask/ZMM state (bits 5-7)
+    unsigned long long xcr0 = osxsave ? enabledStateMask() : 0;
+    bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+    if (avx512 && zmmEnabled)
+        return SimdLevel::AVX512;
+    if (avx && avx2 && fma && ymmEnabled)
+        return SimdLevel::AVX2;
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char *simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE2:
+        return "SSE2";
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::AVX512:
+        return "AVX-512";
+    case SimdLevel::Scalar:
+    default:
+        return "Scalar";
+    }
+}
+
+const SimdKernels &kernelsFor(SimdLevel level)
+{
+    SimdLevel supported = detectSimdLevel();
+    if (level > supported)
+        level = supported;
+
+    const SimdKernels *best = &KERNELS[0];
+    for (const SimdKernels &k : KERNELS)
+        if (k.level <= level)
+            best = &k;
+    return *best;
+}
+
+// Resolved on first use, so static constructors in other translation units can already call it;
+// after that each call is one guard check and a load
+const SimdKernels &activeKernels()
+{
+    static const SimdKernels &active = kernelsFor(SimdLevel::AVX512);
+    return active;
+}
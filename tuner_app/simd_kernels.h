@@ -0,0 +1,43 @@
+#include <cstddef>
+#pragma once
+
+// Instruction set levels for the vectorized inner loops, in increasing order
+enum class SimdLevel
+{
+    Scalar, // portable fallback, bit-identical to the original loops
+    SSE2,
+    AVX2,   // AVX2 + FMA
+    AVX512  // AVX-512F
+};
+
+// Vectorized kernels for the tuner's hot loops. Every level computes the same quantities as the
+// scalar version, but sums are reassociated (and fused with FMA on AVX2/AVX-512), so results differ by
+// rounding only: |simd - scalar| <= SIMD_TOLERANCE * sum(|a[i] * b[i]|) for n up to 65536.
+#define SIMD_TOLERANCE 1e-5f
+
+struct SimdKernels
+{
+    SimdLevel level;
+
+    // sum(a[i] * b[i]): autocorrelation inner product
+    float (*dot)(const float *a, const float *b, int n);
+
+    // out[i] = a[i] * b[i]: windowing
+    void (*multiply)(const float *a, const float *b, float *out, int n);
+
+    // sum(a[i]^2): RMS / frame energy
+    float (*sumSquares)(const float *a, int n);
+
+    // out[i] += scale * a[i]: one FIR tap applied across a block of outputs
+    void (*multiplyAdd)(const float *a, float scale, float *out, int n);
+};
+
+// Highest level supported by both the CPU (cpuid) and the OS (saved register state)
+SimdLevel detectSimdLevel();
+const char *simdLevelName(SimdLevel level);
+
+// Kernels chosen once, on the first call, from detectSimdLevel()
+const SimdKernels &activeKernels();
+
+// Kernels for a specific level, or the best supported level below it; for validation and benchmarks
+const SimdKernels &kernelsFor(SimdLevel level);
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#pragma once
+
+// Wait-free single-producer/single-consumer ring of fixed capacity (rounded up to a power of two).
+// All storage is allocated in the constructor; push and pop never allocate, lock or block,
+// so one side may be the audio callback.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer: slot to fill in place, or nullptr if the queue is full. Call publish() when done.
+    T *writeSlot()
+    {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) > mask)
+            return nullptr;
+        return &slots[h & mask];
+    }
+
+    void publish()
+    {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPush(const T &value)
+    {
+        T *slot = writeSlot();
+        if (!slot)
+            return false;
+        *slot = value;
+        publish();
+        return true;
+    }
+
+    // Consumer: oldest element, or nullptr if empty. Call release() when done with it.
+    T *readSlot()
+    {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[t & mask];
+    }
+
+    void release()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPop(T &value)
+    {
+        T *slot = readSlot();
+        if (!slot)
+            return false;
+        value = *slot;
+        release();
+        return true;
+    }
+
+    // Approximate when called concurrently with the other side
+    std::size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+private:
+    std::vector<T> slots;
+    std::size_t mask;
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
@@ -0,0 +1,302 @@
+#include "streaming_analyzer.h"
+#include <algorithm>
+#include <cmath>
+
+// Exact recomputation of the running correlation and energy every this many windows of input
+#define REFRESH_WINDOWS 32
+
+// Adaptive rate: readings this close to the previous one count as steady, and this many steady
+// readings in a row halve the analysis rate
+#define STEADY_CENTS 2.0f
+#define STEADY_READINGS 4
+
+StreamingAnalyzer::StreamingAnalyzer(int windowSize, int hopSize, int maxWindowSize)
+    : windowSize(windowSize), hopSize(hopSize), capacity(std::max(windowSize, maxWindowSize))
+{
+    history.assign(2 * capacity, 0.0f);
+    runningCorrelation.assign(capacity, 0.0);
+    correlationSnapshot.assign(capacity, 0.0f);
+}
+
+void StreamingAnalyzer::setDetector(FrequencyDetector *d)
+{
+    detector = d;
+    lags = 0;
+}
+
+void StreamingAnalyzer::setStrobe(StrobeTracker *s)
+{
+    strobe = s;
+    lags = 0;
+}
+
+void StreamingAnalyzer::setOnsets(OnsetDetector *o)
+{
+    onsets = o;
+    noteStart = -1;
+}
+
+void StreamingAnalyzer::setAdaptive(bool enabled)
+{
+    adaptive = enabled;
+    stride = 1;
+    steadyReadings = 0;
+    lastPitch = 0.0f;
+}
+
+bool StreamingAnalyzer::isAdaptive() const
+{
+    return adaptive;
+}
+
+int StreamingAnalyzer::getInterval() const
+{
+    return reading.rms < silenceThreshold ? 0 : hopSize * stride;
+}
+
+void StreamingAnalyzer::setIncremental(bool enabled)
+{
+    incremental = enabled;
+    lags = 0;
+}
+
+bool StreamingAnalyzer::isIncremental() const
+{
+    return incremental;
+}
+
+void StreamingAnalyzer::setSilenceThreshold(float rms)
+{
+    silenceThreshold = rms;
+}
+
+void StreamingAnalyzer::reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    std::fill(runningCorrelation.begin(), runningCorrelation.end(), 0.0);
+    pos = -1;
+    samplesSeen = 0;
+    samplesSinceHop = 0;
+    samplesSinceRefresh = 0;
+    energy = 0.0;
+    samplesSinceEnergy = 0;
+    noteStart = -1;
+    stride = 1;
+    steadyReadings = 0;
+    lastPitch = 0.0f;
+    reading = StreamReading();
+    if (strobe)
+        strobe->reset();
+    if (onsets)
+        onsets->reset();
+}
+
+void StreamingAnalyzer::setWindowSize(int size)
+{
+    windowSize = std::min(std::max(size, 2), capacity);
+    lags = 0;
+    refreshEnergy();
+}
+
+int StreamingAnalyzer::getWindowSize() const
+{
+    return windowSize;
+}
+
+int StreamingAnalyzer::getHopSize() const
+{
+    return hopSize;
+}
+
+const StreamReading &StreamingAnalyzer::latest() const
+{
+    return reading;
+}
+
+int StreamingAnalyzer::push(const float *input, int size)
+{
+    if (strobe)
+        return pushStrobe(input, size);
+
+    int analyses = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        pos = (pos + 1 == capacity) ? 0 : pos + 1;
+        float x = input[i];
+
+        // Slide the energy and correlation windows: drop the pairs that start at the outgoing
+        // sample, then add the pairs that end at the incoming one
+        const float *older = &history[pos + capacity - windowSize];
+        double outgoing = older[0];
+        energy += static_cast<double>(x) * x - outgoing * outgoing;
+        if (lags > 0)
+        {
+            for (int lag = 0; lag < lags; ++lag)
+                runningCorrelation[lag] -= outgoing * older[lag];
+        }
+
+        history[pos] = x;
+        history[pos + capacity] = x;
+
+        if (lags > 0)
+        {
+            const float *newest = &history[pos + capacity];
+            for (int lag = 0; lag < lags; ++lag)
+                runningCorrelation[lag] += static_cast<double>(x) * newest[-lag];
+        }
+
+        ++samplesSeen;
+        ++samplesSinceRefresh;
+        ++samplesSinceEnergy;
+        if (onsets && onsets->push(x))
+        {
+            noteStart = samplesSeen + onsets->getSettleSamples();
+            stride = 1;
+            steadyReadings = 0;
+        }
+
+        if (noteStart >= 0)
+        {
+            // Windows ending inside the pick transient are skipped; the first one past it is analyzed
+            // at once and the hop grid restarts from there. Right after reset() that waits for the
+            // window to fill, as the hop path does.
+            if (samplesSeen >= noteStart && samplesSeen >= windowSize)
+            {
+                noteStart = -1;
+                samplesSinceHop = 0;
+                analyzeWindow();
+                reading.onset = true;
+                ++analyses;
+            }
+        }
+        else if (samplesSeen >= windowSize && ++samplesSinceHop >= hopSize * stride)
+        {
+            samplesSinceHop = 0;
+            analyzeWindow();
+            ++analyses;
+        }
+    }
+    return analyses;
+}
+
+int StreamingAnalyzer::pushStrobe(const float *input, int size)
+{
+    int hops = strobe->push(input, size);
+
+    // Plain window update; lags is 0 while the strobe runs, so there is no correlation to slide
+    for (int i = 0; i < size; ++i)
+    {
+        pos = (pos + 1 == capacity) ? 0 : pos + 1;
+        double outgoing = history[pos + capacity - windowSize];
+        energy += static_cast<double>(input[i]) * input[i] - outgoing * outgoing;
+        history[pos] = input[i];
+        history[pos + capacity] = input[i];
+    }
+    samplesSeen += size;
+    samplesSinceEnergy += size;
+
+    if (hops > 0)
+    {
+        const StrobeReading &latest = strobe->latest();
+        reading.rms = latest.rms;
+        reading.endSample = samplesSeen;
+        reading.phase = latest.phase;
+        reading.onset = false;
+        reading.pitch = latest.rms < silenceThreshold ? PitchResult() : latest.pitch;
+    }
+    return hops;
+}
+
+void StreamingAnalyzer::analyzeWindow()
+{
+    if (!detector)
+        return;
+
+    const float *frame = &history[pos + capacity - windowSize + 1];
+
+    if (samplesSinceEnergy >= REFRESH_WINDOWS * windowSize)
+        refreshEnergy();
+    reading.rms = static_cast<float>(std::sqrt(std::max(energy, 0.0) / windowSize));
+    reading.endSample = samplesSeen;
+    reading.onset = false;
+    reading.pitch = PitchResult();
+    if (reading.rms < silenceThreshold)
+    {
+        // Gate closed: stop sliding the correlation until there is something to analyze again
+        if (adaptive)
+        {
+            lags = 0;
+            stride = 1;
+            steadyReadings = 0;
+            lastPitch = 0.0f;
+        }
+        return;
+    }
+
+    const float *precomputed = nullptr;
+    if (incremental && stride == 1 && detector->usesRawCorrelation())
+    {
+        int needed = detector->correlationLength(windowSize);
+        if (needed != lags || samplesSinceRefresh >= REFRESH_WINDOWS * windowSize)
+        {
+            lags = needed;
+            refreshCorrelation();
+        }
+        for (int lag = 0; lag < lags; ++lag)
+            correlationSnapshot[lag] = static_cast<float>(runningCorrelation[lag]);
+        precomputed = correlationSnapshot.data();
+    }
+    else
+    {
+        lags = 0;
+    }
+
+    reading.pitch = detector->analyze(frame, windowSize, precomputed);
+    if (adaptive)
+        schedule();
+}
+
+void StreamingAnalyzer::schedule()
+{
+    float pitch = reading.pitch.frequency;
+    bool moved;
+    if (pitch > 0.0f && lastPitch > 0.0f)
+        moved = std::fabs(1200.0f * std::log2(pitch / lastPitch)) > STEADY_CENTS;
+    else
+        moved = (pitch > 0.0f) != (lastPitch > 0.0f); // a pitch appeared or vanished
+    lastPitch = pitch;
+
+    if (moved)
+    {
+        stride = 1;
+        steadyReadings = 0;
+    }
+    else if (++steadyReadings >= STEADY_READINGS && stride < MAX_STRIDE)
+    {
+        stride *= 2;
+        steadyReadings = 0;
+    }
+}
+
+void StreamingAnalyzer::refreshCorrelation()
+{
+    const float *frame = &history[pos + capacity - windowSize + 1];
+    for (int lag = 0; lag < lags; ++lag)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < windowSize - lag; ++i)
+            sum += static_cast<double>(frame[i]) * frame[i + lag];
+        runningCorrelation[lag] = sum;
+    }
+    samplesSinceRefresh = 0;
+}
+
+void StreamingAnalyzer::refreshEnergy()
+{
+    const float *frame = &history[pos + capacity - windowSize + 1];
+    double sum = 0.0;
+    for (int i = 0; i < windowSize; ++i)
+        sum += static_cast<double>(frame[i]) * frame[i];
+    energy = sum;
+    samplesSinceEnergy = 0;
+}
@@ -0,0 +1,121 @@
+#include "frequency_detector.h"
+#include "onset_detector.h"
+#include "strobe_tracker.h"
+#include <vector>
+#pragma once
+
+// One analysis produced by StreamingAnalyzer
+struct StreamReading
+{
+    PitchResult pitch;
+    float rms = 0.0f;          // RMS level of the analyzed window
+    long long endSample = 0;   // stream position just past the last sample of the window
+    float phase = 0.0f;        // strobe mode: heterodyne phase in turns
+    bool onset = false;        // first analysis after an attack, run as soon as the pick transient passed
+};
+
+// Sliding-window front end for a FrequencyDetector. Incoming blocks of any size are pushed into an
+// internal ring buffer and the detector runs every `hop` samples over the latest `window` samples.
+// For engines that work on the raw frame's autocorrelation (YIN, MPM) the correlation terms are
+// updated incrementally per sample, O(hop * lags) per analysis instead of O(window * lags).
+// No heap allocations after construction/setDetector(), so push() may run on the audio thread.
+class StreamingAnalyzer
+{
+public:
+    // maxWindowSize reserves room for setWindowSize() to grow the window later (0: windowSize)
+    StreamingAnalyzer(int windowSize, int hopSize, int maxWindowSize = 0);
+
+    // The detector must be configured for at least windowSize samples
+    void setDetector(FrequencyDetector *detector);
+    // While a strobe tracker is set it produces the readings, once per strobe hop, and the detector
+    // is idle; the window keeps filling so the detector can take over again at once
+    void setStrobe(StrobeTracker *strobe);
+
+    // With an onset detector set, no analysis runs while a pick transient dominates the newest audio;
+    // the first window past it is analyzed at once, off the hop grid, which then restarts from there
+    // instead of leaving the first reading of a pluck to wherever the next hop happens to fall.
+    void setOnsets(OnsetDetector *onsets);
+
+    // Adaptive rate: analyze every hop after an onset or while the pitch moves, then double the
+    // interval, up to MAX_STRIDE hops, each time STEADY_READINGS readings agree within STEADY_CENTS.
+    // Below the silence threshold only the gate is checked and the running correlation is dropped,
+    // as it is at any interval above one hop, where recomputing it per analysis is cheaper.
+    void setAdaptive(bool enabled);
+    bool isAdaptive() const;
+
+    // Samples between analyses at the current rate; 0 while the silence gate is closed
+    int getInterval() const;
+
+    void setIncremental(bool enabled);
+    bool isIncremental() const;
+
+    // Windows whose RMS is below this level are not analyzed and report no pitch
+    void setSilenceThreshold(float rms);
+
+    // Forget buffered audio, e.g. after a stream restart
+    void reset();
+
+    // Push a block of samples; returns the number of analyses run
+    int push(const float *input, int size);
+
+    // Most recent reading; valid once push() has returned non-zero at least once
+    const StreamReading &latest() const;
+
+    // Analyze the latest `size` samples from now on, at most maxWindowSize. The ring always holds
+    // maxWindowSize samples, so a larger window is filled from audio already buffered and the switch
+    // costs no gap, only one exact recomputation of the running correlation.
+    // The detector must be configured for at least `size` samples.
+    void setWindowSize(int size);
+    int getWindowSize() const;
+    int getHopSize() const;
+
+private:
+    void analyzeWindow();
+
+    // Adaptive rate: pick the interval to the next analysis from the reading just made
+    void schedule();
+    int pushStrobe(const float *input, int size);
+
+    // Recompute all incremental lags exactly from the buffered window to cancel accumulated rounding
+    void refreshCorrelation();
+    // Recompute the window's running energy exactly, likewise
+    void refreshEnergy();
+
+    FrequencyDetector *detector = nullptr;
+    StrobeTracker *strobe = nullptr;
+    OnsetDetector *onsets = nullptr;
+    int windowSize;
+    int hopSize;
+    bool incremental = true;
+    float silenceThreshold = 0.0f;
+
+    // Mirrored ring of capacity samples: every sample is written at pos and pos + capacity, so the
+    // latest window is always the contiguous range ending at pos + capacity and lag reads never wrap
+    int capacity;
+    std::vector<float> history;
+    int pos = -1;
+    long long samplesSeen = 0;
+    int samplesSinceHop = 0;
+
+    // Running sum of squares of the window, so the silence gate costs O(1) per analysis
+    double energy = 0.0;
+    int samplesSinceEnergy = 0;
+
+    // Adaptive rate state: analyses run every stride hops
+    static constexpr int MAX_STRIDE = 8;
+    bool adaptive = false;
+    int stride = 1;
+    int steadyReadings = 0;
+    float lastPitch = 0.0f;
+
+    // Stream position where the pick transient of the latest onset has passed; -1 once analyzed
+    long long noteStart = -1;
+
+    // Running autocorrelation of the window for lags [0, lags), kept in double to limit drift
+    std::vector<double> runningCorrelation;
+    std::vector<float> correlationSnapshot;
+    int lags = 0;
+    int samplesSinceRefresh = 0;
+
+    StreamReading reading;
+};
@@ -0,0 +1,139 @@
+#include "strobe_tracker.h"
+#include <algorithm>
+#include <cmath>
+#define PI 3.14159265358979323846
+
+// Low-pass corner as a fraction of the target: the second harmonic and the mirror image of the
+// fundamental land at least one target frequency away from DC and are attenuated by ~18 dB per
+// octave per pole
+#define CUTOFF_RATIO 0.125f
+#define MIN_CUTOFF 2.0f
+
+StrobeTracker::StrobeTracker(float sampleRate, int hopSize)
+    : sampleRate(sampleRate), hopSize(hopSize)
+{
+    reset();
+}
+
+void StrobeTracker::setTarget(float freq)
+{
+    target = freq;
+    double w = 2.0 * PI * freq / sampleRate;
+    rotation = std::complex<float>(static_cast<float>(std::cos(w)), static_cast<float>(-std::sin(w)));
+
+    float cutoff = std::max(MIN_CUTOFF, CUTOFF_RATIO * freq);
+    smoothing = static_cast<float>(1.0 - std::exp(-2.0 * PI * cutoff * DECIMATION / sampleRate));
+    reset();
+}
+
+float StrobeTracker::getTarget() const
+{
+    return target;
+}
+
+void StrobeTracker::reset()
+{
+    oscillator = std::complex<float>(1.0f, 0.0f);
+    boxcar = std::complex<float>(0.0f, 0.0f);
+    boxcarCount = 0;
+    for (int p = 0; p < POLES; ++p)
+        lowpass[p] = std::complex<float>(0.0f, 0.0f);
+    previous = std::complex<float>(0.0f, 0.0f);
+    energy = 0.0;
+    samplesSinceHop = 0;
+    for (int i = 0; i < SPAN; ++i)
+    {
+        increments[i] = 0.0f;
+        hopEnergy[i] = 0.0;
+    }
+    incrementCount = 0;
+    nextIncrement = 0;
+    phase = 0.0;
+    reading = StrobeReading();
+}
+
+int StrobeTracker::push(const float *input, int size)
+{
+    if (target <= 0.0f)
+        return 0;
+
+    int hops = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        float x = input[i];
+        boxcar += x * oscillator;
+        oscillator *= rotation;
+        energy += x * x;
+
+        if (++boxcarCount == DECIMATION)
+        {
+            std::complex<float> value = boxcar * (1.0f / DECIMATION);
+            for (int p = 0; p < POLES; ++p)
+            {
+                lowpass[p] += smoothing * (value - lowpass[p]);
+                value = lowpass[p];
+            }
+            boxcar = std::complex<float>(0.0f, 0.0f);
+            boxcarCount = 0;
+        }
+
+        if (++samplesSinceHop == hopSize)
+        {
+            measure();
+            samplesSinceHop = 0;
+            ++hops;
+        }
+    }
+
+    // Pull the oscillator back onto the unit circle; first-order correction, no sqrt needed
+    oscillator *= 1.5f - 0.5f * std::norm(oscillator);
+    return hops;
+}
+
+void StrobeTracker::measure()
+{
+    // Level over the last SPAN hops; a single hop can be shorter than one period of the low strings
+    std::complex<float> current = lowpass[POLES - 1];
+    hopEnergy[nextIncrement] = energy;
+    energy = 0.0;
+    double total = 0.0;
+    int hops = std::min(incrementCount + 1, SPAN);
+    for (int i = 0; i < SPAN; ++i)
+        total += hopEnergy[i];
+    reading.rms = static_cast<float>(std::sqrt(total / (hops * hopSize)));
+
+    // Phase advance since the last hop; the low-pass keeps it well inside +-pi
+    std::complex<float> turn = current * std::conj(previous);
+    previous = current;
+    if (std::norm(turn) <= 0.0f)
+    {
+        hopEnergy[nextIncrement] = 0.0;
+        return;
+    }
+    float increment = std::atan2(turn.imag(), turn.real());
+
+    increments[nextIncrement] = increment;
+    nextIncrement = (nextIncrement + 1) % SPAN;
+    incrementCount = std::min(incrementCount + 1, SPAN);
+    float incrementSum = 0.0f;
+    for (int i = 0; i < incrementCount; ++i)
+        incrementSum += increments[i];
+
+    phase += increment / (2.0 * PI);
+    phase -= std::floor(phase);
+    reading.phase = static_cast<float>(phase);
+
+    float offset = static_cast<float>(incrementSum / incrementCount * sampleRate / (2.0 * PI * hopSize));
+    reading.pitch.frequency = target + offset;
+
+    // A sinusoid of amplitude A leaves a phasor of magnitude A / 2 and has RMS A / sqrt(2)
+    float magnitude = std::abs(current);
+    reading.pitch.confidence = incrementCount < SPAN || reading.rms <= 0.0f
+                                   ? 0.0f
+                                   : std::min(1.0f, 1.41421356f * magnitude / reading.rms);
+}
+
+const StrobeReading &StrobeTracker::latest() const
+{
+    return reading;
+}
@@ -0,0 +1,65 @@
+#include "frequency_detector.h"
+#include <complex>
+#pragma once
+
+// One strobe measurement, taken every hop
+struct StrobeReading
+{
+    PitchResult pitch;
+    float rms = 0.0f;   // RMS level over the hops the estimate averages
+    float phase = 0.0f; // heterodyne phase in turns, 0..1; a strobe display rotates with it
+};
+
+// Strobe-style tuner for a known target. The input is mixed against the target with a recursive
+// complex oscillator, boxcar-decimated per block and low-passed by a cascade of one-pole filters
+// well below the target, which leaves the fundamental as a slowly turning phasor. Its phase advance
+// from hop to hop is the frequency offset from the target: a fraction of a cent is visible after a
+// few 256-sample hops, where autocorrelation needs several periods of the lowest string per frame.
+// Stateful and streaming; push() performs no allocations and no per-sample transcendental calls.
+class StrobeTracker
+{
+public:
+    StrobeTracker(float sampleRate, int hopSize);
+
+    // Retune the oscillator and the low-pass to a new target and restart tracking
+    void setTarget(float freq);
+    float getTarget() const;
+    void reset();
+
+    // Push a block of samples; returns the number of hops completed
+    int push(const float *input, int size);
+
+    // Most recent measurement; confidence stays 0 until SPAN hops have been tracked
+    const StrobeReading &latest() const;
+
+private:
+    static constexpr int DECIMATION = 16; // boxcar decimation ahead of the low-pass
+    static constexpr int POLES = 4;       // one-pole low-pass sections
+    static constexpr int SPAN = 8;        // hops averaged per frequency estimate
+
+    void measure();
+
+    float sampleRate;
+    int hopSize;
+    float target = 0.0f;
+
+    // Recursive oscillator e^(-jwn); renormalized every block instead of calling cos/sin per sample
+    std::complex<float> oscillator{1.0f, 0.0f};
+    std::complex<float> rotation{1.0f, 0.0f};
+
+    std::complex<float> boxcar{0.0f, 0.0f};
+    int boxcarCount = 0;
+    float smoothing = 0.0f; // one-pole coefficient at the decimated rate
+    std::complex<float> lowpass[POLES];
+
+    std::complex<float> previous{0.0f, 0.0f};
+    double energy = 0.0;
+    int samplesSinceHop = 0;
+    float increments[SPAN]; // phase advance of each of the last hops, radians
+    double hopEnergy[SPAN]; // sum of squares of each of the last hops
+    int incrementCount = 0;
+    int nextIncrement = 0;
+    double phase = 0.0;
+
+    StrobeReading reading;
+};
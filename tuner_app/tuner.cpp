@@ -1,41 +1,262 @@
 #include "tuner.h"
-#define BUFFER_SIZE 2048
+#include "alloc_counter.h"
+#include "notes.h"
+#define BUFFER_SIZE 256
 #define SAMPLE_RATE 48000
+#define WINDOW_SIZE 2048
+#define HOP_SIZE 256
+// Window for bass and extended-range tunings: 2048 samples cannot hold two periods of anything
+// below about 47 Hz, so E1 (41 Hz), B0 (31 Hz) and F#1 (46 Hz) would never be found
+#define LOW_WINDOW_SIZE 4096
+#define LOW_REGISTER_FREQ 60.0f   // a lowest pitch below this selects LOW_WINDOW_SIZE
+#define SILENCE_RMS 0.01f
+#define FIRST_READING_TIMEOUT std::chrono::seconds(2)
+#define SETTINGS_RETRY_TIMEOUT std::chrono::milliseconds(100)
+#define MIN_REFERENCE_A4 400.0f
+#define MAX_REFERENCE_A4 480.0f
+#define STROBE_WIDTH 24
+#define METER_WIDTH 41            // needle positions over -50..+50 cents, odd so 0 has its own
+#define METER_LINE_CAPACITY 256   // bytes of one formatted meter line, escapes included
+#define IN_TUNE_CENTS 3.0f        // the verdict reads "In tune" within this many cents of the reference
+#define READING_HOLD std::chrono::milliseconds(400)
 
-GuitarTuner::GuitarTuner() : detector(SAMPLE_RATE), frameCount(0) {}
+// Set from the signal handler that ends headless mode
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+static_assert(MAX_TUNING_STRINGS <= MAX_STRINGS, "every named tuning must fit auto string mode");
+
+// Lowest pitch the settings may ask for: the target in target mode, otherwise the lowest string of
+// the selected tuning, which chromatic mode keeps in s.strings too
+static float lowestPitch(const TunerSettings &s)
+{
+    if (s.mode == DetectionMode::Target)
+        return s.targetFreq;
+    float lowest = MAX_DETECT_FREQ;
+    for (int i = 0; i < s.stringCount; ++i)
+        lowest = std::min(lowest, s.strings[i]);
+    return lowest;
+}
+
+GuitarTuner::Channel::Channel()
+    : strobe(SAMPLE_RATE, HOP_SIZE), onsets(SAMPLE_RATE), analyzer(WINDOW_SIZE, HOP_SIZE, LOW_WINDOW_SIZE)
+{
+    for (int e = 0; e < ENGINE_COUNT; ++e)
+    {
+        engines[e] = FrequencyDetector::create(static_cast<PitchEngine>(e), SAMPLE_RATE, LOW_WINDOW_SIZE);
+        engines[e]->prepareFrameSize(WINDOW_SIZE);
+    }
+    analyzer.setSilenceThreshold(SILENCE_RMS);
+    onsets.setSilenceThreshold(SILENCE_RMS);
+    analyzer.setOnsets(&onsets);
+    analyzer.setAdaptive(true);
+}
+
+GuitarTuner::GuitarTuner(int channelCount, int firstChannel)
+    : firstChannel(firstChannel)
+{
+    std::vector<StreamingAnalyzer *> analyzers;
+    for (int c = 0; c < std::max(1, channelCount); ++c)
+    {
+        channels.push_back(std::unique_ptr<Channel>(new Channel()));
+        analyzers.push_back(&channels.back()->analyzer);
+    }
+    pipeline.reset(new TunerPipeline(analyzers, [this](int channel, const TunerSettings &s)
+                                     { applySettings(channel, s); },
+                                     [this](const std::vector<TunerReading> &frame)
+                                     { drawFrame(frame); }));
+    frameText.resize(channels.size() * METER_LINE_CAPACITY + 16);
+
+    // Standard tuning at A4 = 440 Hz
+    settings.mode = DetectionMode::Chromatic;
+    retune();
+    channelSettings.assign(channels.size(), settings);
+}
 
 void GuitarTuner::run()
 {
-    while (true)
+    // The device stays open across string changes, which only post new settings to the pipeline.
+    // If it cannot be opened, or fails while tuning, the error is reported and the menu comes back;
+    // the next selection opens it again.
+    RtAudio audio(RtAudio::WINDOWS_ASIO, [this](RtAudioErrorType type, const std::string &)
+                  { streamError(type); });
+    try
+    {
+        openSession(audio);
+    }
+    catch (const std::exception &e)
     {
-        if (!selectString())
-            break;
+        stopStream(audio);
+        std::cerr << "Audio error: " << e.what() << "\n";
+    }
 
+    while (selectString())
+    {
         try
         {
-            RtAudio audio(RtAudio::WINDOWS_ASIO);
-            inputParams.deviceId = audio.getDefaultInputDevice();
-            inputParams.nChannels = 1;
-            inputParams.firstChannel = 1;
+            if (!audio.isStreamRunning())
+                openSession(audio);
 
-            unsigned int bufferSize = BUFFER_SIZE;
-            audio.openStream(nullptr, &inputParams, RTAUDIO_FLOAT32, SAMPLE_RATE, &bufferSize, &audioCallbackWrapper, this);
-            std::cout << "Tuning '" << currentString << "' (" << targetFreq << " Hz)... Press Enter to stop.\n";
-            audio.startStream();
+            if (settings.mode == DetectionMode::Chromatic)
+                std::cout << "Chromatic mode (A4 = " << settings.a4 << " Hz)... Press Enter to stop.\n";
+            else if (settings.mode == DetectionMode::Strings)
+                std::cout << "Auto string mode, play any string... Press Enter to stop.\n";
+            else
+                std::cout << "Tuning '" << noteName(settings.targetNote) << noteOctave(settings.targetNote) << "' ("
+                          << settings.targetFreq << " Hz)... Press Enter to stop.\n";
 
+            displaying = true;
             std::thread([]
                         { std::cin.get(); })
                 .join();
+            {
+                // A frame may be halfway out on the render thread; wait for it so nothing is drawn
+                // over the lines below
+                std::lock_guard<std::mutex> lock(frameMutex);
+                displaying = false;
+            }
 
-            audio.stopStream();
-            audio.closeStream();
-            std::cout << "Tuning stopped.\n\n";
+            std::cout << "Tuning stopped.\n";
+            printStats();
+            if (streamFailed)
+                throw std::runtime_error(audio.getErrorText());
         }
         catch (const std::exception &e)
         {
-            std::cerr << "Audio error: " << e.what() << "\n";
+            stopStream(audio);
+            std::cerr << "Audio error: " << e.what() << "\nThe device is reopened when tuning starts again.\n";
         }
     }
+
+    stopStream(audio);
+}
+
+void GuitarTuner::openSession(RtAudio &audio)
+{
+    PipelineClock::time_point opening = PipelineClock::now();
+    startStream(audio);
+    PipelineClock::time_point started = PipelineClock::now();
+
+    // What every string change used to cost: device open/start plus refilling the analysis window
+    while (pipeline->getStats().readings == 0 && PipelineClock::now() - started < FIRST_READING_TIMEOUT)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    PipelineClock::time_point ready = PipelineClock::now();
+    std::cout << "Audio stream open in " << std::chrono::duration<double, std::milli>(started - opening).count()
+              << " ms, first reading after " << std::chrono::duration<double, std::milli>(ready - opening).count()
+              << " ms. String changes retarget the running stream.\n";
+    if (channels.size() > 1)
+        std::cout << channels.size() << " inputs on " << pipeline->getWorkerCount() << " analysis workers.\n";
+}
+
+void GuitarTuner::streamError(RtAudioErrorType type)
+{
+    if (type == RTAUDIO_WARNING)
+        streamWarnings.fetch_add(1, std::memory_order_relaxed);
+    else
+        streamFailed = true;
+}
+
+void GuitarTuner::runHeadless(const std::string &ringName)
+{
+    // Outlives the try block so the workers are stopped before it goes away
+    std::unique_ptr<PitchRingWriter> ring;
+    try
+    {
+        ring.reset(new PitchRingWriter(ringName, static_cast<int>(channels.size())));
+        PitchRingWriter *writer = ring.get();
+        pipeline->setPublisher([this, writer](const TunerReading &reading)
+                               { publishReading(*writer, reading); });
+
+        RtAudio audio(RtAudio::WINDOWS_ASIO, [this](RtAudioErrorType type, const std::string &)
+                      { streamError(type); });
+        startStream(audio);
+        std::cout << "Publishing " << channels.size() << " input(s) to shared memory '" << ringName
+                  << "' (chromatic, A4 = " << settings.a4 << " Hz)... Press Ctrl+C to stop.\n";
+
+        stopRequested = 0;
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        while (!stopRequested && !streamFailed)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+
+        // Nobody is there to reopen a failed device, so headless mode ends with it
+        std::string failure = streamFailed ? audio.getErrorText() : std::string();
+        stopStream(audio);
+        if (!failure.empty())
+            std::cerr << "Audio error: " << failure << "\n";
+        std::cout << "Publishing stopped.\n";
+        printStats();
+    }
+    catch (const std::exception &e)
+    {
+        pipeline->stop();
+        std::cerr << "Audio error: " << e.what() << "\n";
+    }
+    pipeline->setPublisher(nullptr);
+}
+
+void GuitarTuner::startStream(RtAudio &audio)
+{
+    inputParams.deviceId = audio.getDefaultInputDevice();
+    inputParams.nChannels = static_cast<unsigned int>(channels.size());
+    inputParams.firstChannel = firstChannel;
+
+    unsigned int bufferSize = BUFFER_SIZE;
+    for (std::unique_ptr<Channel> &channel : channels)
+        channel->analyzer.reset();
+    streamFailed = false;
+    audio.openStream(nullptr, &inputParams, RTAUDIO_FLOAT32, SAMPLE_RATE, &bufferSize, &audioCallbackWrapper, this);
+    if (!audio.isStreamOpen())
+        throw std::runtime_error(audio.getErrorText());
+
+    postSettings();
+    pipeline->start();
+    audio.startStream();
+    if (!audio.isStreamRunning())
+        throw std::runtime_error(audio.getErrorText());
+}
+
+void GuitarTuner::stopStream(RtAudio &audio)
+{
+    if (audio.isStreamRunning())
+        audio.stopStream();
+    if (audio.isStreamOpen())
+        audio.closeStream();
+    pipeline->stop();
+
+#ifndef NDEBUG
+    // violations() counts the callback and the analysis guards together
+    std::uint64_t analysisAllocations = pipeline->getStats().allocatingBlocks;
+    std::uint64_t callbackAllocations = AllocationCounter::violations() - analysisAllocations;
+    if (callbackAllocations > 0)
+        std::cerr << "Warning: " << callbackAllocations << " audio callbacks allocated memory.\n";
+    if (analysisAllocations > 0)
+        std::cerr << "Warning: " << analysisAllocations << " analysis blocks allocated memory.\n";
+#endif
+}
+
+// Runs on an analysis worker: no locks, no allocation, table lookups only
+void GuitarTuner::publishReading(PitchRingWriter &ring, const TunerReading &reading)
+{
+    PitchSample sample;
+    sample.timeNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(reading.captured.time_since_epoch()).count();
+    sample.flags = reading.onset ? PITCH_ONSET : 0;
+    float frequency = reading.pitch.frequency;
+    if (frequency > MIN_DETECT_FREQ && frequency < MAX_DETECT_FREQ)
+    {
+        NoteInfo note = nearestNote(frequency, reading.settings.a4, reading.settings.temperament);
+        sample.frequency = frequency;
+        sample.confidence = reading.pitch.confidence;
+        sample.cents = note.cents;
+        sample.midi = note.midi;
+    }
+    ring.publish(reading.channel, sample);
 }
 
 int GuitarTuner::audioCallbackWrapper(void *, void *inputBuffer, unsigned int nFrames, double, RtAudioStreamStatus status, void *userData)
@@ -46,49 +267,307 @@ int GuitarTuner::audioCallbackWrapper(void *, void *inputBuffer, unsigned int nF
 int GuitarTuner::audioCallback(float *input, unsigned int nFrames, RtAudioStreamStatus status)
 {
     if (status)
-        std::cerr << "Stream warning.\n";
+        streamWarnings.fetch_add(1, std::memory_order_relaxed);
+
+    // Debug builds count any heap allocation made on the audio thread
+    AllocationGuard allocationGuard;
+
+    // Everything else happens on the pipeline's analysis and render threads
+    pipeline->pushBlock(input, nFrames);
+    return 0;
+}
+
+void GuitarTuner::applySettings(int c, const TunerSettings &s)
+{
+    Channel &channel = *channels[c];
+    FrequencyDetector *next = channel.engines[static_cast<int>(s.engine)].get();
+    next->setCorrelationMethod(s.method);
+    next->setTargetSearch(s.targetSearch);
+    if (s.mode == DetectionMode::Strings)
+        next->setStrings(s.strings, s.stringCount);
+    else if (s.mode == DetectionMode::Chromatic)
+        next->setChromatic();
+    else
+        next->setTarget(s.targetFreq);
 
-    if (++frameCount < 10)
-        return 0;
+    // Switching engines keeps the buffered window; the analyzer only rebuilds its correlation terms
+    if (next != channel.detector)
+    {
+        channel.detector = next;
+        channel.analyzer.setDetector(next);
+    }
 
-    // Compute RMS to ignore silence, Root Mean Square — it's a mathematical way of measuring the average energy or amplitude of a signal
-    float rms = 0;
-    for (unsigned int i = 0; i < nFrames; ++i)
-        rms += input[i] * input[i];
-    rms = std::sqrt(rms / nFrames);
+    // Low tunings and targets get the longer window, everything else keeps the faster one
+    int window = lowestPitch(s) < LOW_REGISTER_FREQ ? LOW_WINDOW_SIZE : WINDOW_SIZE;
+    if (window != channel.analyzer.getWindowSize())
+        channel.analyzer.setWindowSize(window);
 
-    if (rms < 0.01f)
+    // While attached the strobe only restarts when its target changes, so toggling other settings keeps
+    // it locked. Attaching it always restarts it: whatever it tracked before it was detached is stale.
+    if (s.strobe && s.mode == DetectionMode::Target)
+    {
+        if (!channel.strobing || channel.strobe.getTarget() != s.targetFreq)
+            channel.strobe.setTarget(s.targetFreq);
+        channel.analyzer.setStrobe(&channel.strobe);
+        channel.strobing = true;
+    }
+    else
     {
-        frameCount = 0;
-        return 0;
+        channel.analyzer.setStrobe(nullptr);
+        channel.strobing = false;
     }
+}
 
-    float detected = detector.detect(input, nFrames);
-    if (detected > 20 && detected < 1500)
+bool GuitarTuner::postSettings()
+{
+    ++settings.sequence;
+    settings.issued = PipelineClock::now();
+    bool posted = true;
+    for (int c = 0; c < static_cast<int>(channels.size()); ++c)
     {
-        std::cout << "Detected: " << detected << " Hz | Target: " << targetFreq << " Hz | ";
-        if (std::abs(detected - targetFreq) <= 1.0f)
-            std::cout << "\033[32mIn tune\033[0m\n";
-        else if (detected > targetFreq)
-            std::cout << "\033[31mToo sharp\033[0m\n";
+        if (selectedChannel >= 0 && c != selectedChannel)
+            continue;
+
+        // The worker drains the queue before every block, so a full queue normally empties within
+        // a few milliseconds; give it that long before giving up on the change
+        bool pushed = pipeline->postSettings(c, settings);
+        PipelineClock::time_point deadline = PipelineClock::now() + SETTINGS_RETRY_TIMEOUT;
+        while (!pushed && pipeline->isRunning() && PipelineClock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            pushed = pipeline->postSettings(c, settings);
+        }
+
+        // Only what the input will actually run becomes its recorded state
+        if (pushed)
+        {
+            channelSettings[c] = settings;
+        }
         else
-            std::cout << "\033[34mToo flat\033[0m\n";
+        {
+            std::cerr << "Settings queue of input " << inputNumber(c) << " full, change ignored.\n";
+            posted = false;
+        }
     }
 
-    frameCount = 0;
-    return 0;
+    // Editing a single input continues from what it runs, not from the change it refused
+    if (!posted && selectedChannel >= 0)
+        settings = channelSettings[selectedChannel];
+    return posted;
+}
+
+void GuitarTuner::selectInput()
+{
+    std::string input;
+    std::cout << "Input (" << inputNumber(0) << "-" << inputNumber(static_cast<int>(channels.size()) - 1)
+              << ", or 0 for all): ";
+    std::getline(std::cin, input);
+
+    int number = -1;
+    try
+    {
+        number = std::stoi(input);
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    if (number == 0)
+    {
+        selectedChannel = -1;
+        std::cout << "Settings apply to all inputs\n";
+        return;
+    }
+    int c = number - inputNumber(0);
+    if (c < 0 || c >= static_cast<int>(channels.size()))
+    {
+        std::cout << "\033[1;31mInvalid input!\033[0m\n";
+        return;
+    }
+
+    // Continue editing from what that input is doing now
+    selectedChannel = c;
+    settings = channelSettings[c];
+    std::cout << "Settings apply to input " << number << "\n";
+}
+
+int GuitarTuner::inputNumber(int channel) const
+{
+    return firstChannel + channel + 1;
+}
+
+// Runs on the render thread at the pipeline's frame rate. Each input gets one line, redrawn in
+// place; the whole frame goes out in a single write.
+void GuitarTuner::drawFrame(const std::vector<TunerReading> &frame)
+{
+    std::lock_guard<std::mutex> lock(frameMutex);
+    if (!displaying)
+    {
+        drawnLines = 0;
+        return;
+    }
+
+    PipelineClock::time_point now = PipelineClock::now();
+    char *out = frameText.data();
+    int length = 0;
+
+    // Back to the first line of the previous frame
+    if (drawnLines > 1)
+        length += std::snprintf(out, frameText.size(), "\033[%dA", drawnLines - 1);
+    out[length++] = '\r';
+    for (std::size_t c = 0; c < frame.size(); ++c)
+    {
+        if (c > 0)
+            out[length++] = '\n';
+        length += formatMeter(out + length, METER_LINE_CAPACITY, frame[c], now);
+    }
+    drawnLines = static_cast<int>(frame.size());
+
+    std::fwrite(out, 1, length, stdout);
+    std::fflush(stdout);
+}
+
+// snprintf at out + length that advances length by what was written, so it never passes capacity - 1
+// even when the output was cut short
+static void appendFormat(char *out, int capacity, int &length, const char *format, ...)
+{
+    if (length >= capacity - 1)
+        return;
+    va_list args;
+    va_start(args, format);
+    int written = std::vsnprintf(out + length, capacity - length, format, args);
+    va_end(args);
+    if (written > 0)
+        length = std::min(length + written, capacity - 1);
+}
+
+// One meter line: note, cents, needle (or strobe) and the tuning verdict. Readings without a pitch
+// in range, or older than READING_HOLD, leave the meter empty.
+int GuitarTuner::formatMeter(char *out, int capacity, const TunerReading &reading, PipelineClock::time_point now) const
+{
+    const PitchResult &result = reading.pitch;
+    const TunerSettings &active = reading.settings;
+    int length = 0;
+    appendFormat(out, capacity, length, "\033[2K");
+    if (channels.size() > 1)
+        appendFormat(out, capacity, length, "[In %d] ", inputNumber(reading.channel));
+
+    bool valid = result.frequency > MIN_DETECT_FREQ && result.frequency < MAX_DETECT_FREQ && now - reading.posted < READING_HOLD &&
+                 (active.mode != DetectionMode::Strings || result.stringIndex >= 0);
+    if (!valid)
+    {
+        appendFormat(out, capacity, length, "--");
+        return length;
+    }
+
+    // In chromatic mode the nearest note becomes the reference, in auto string mode the detected string
+    float detected = result.frequency;
+    float reference = active.targetFreq;
+    int midi = active.targetNote;
+    float cents;
+    if (active.mode == DetectionMode::Chromatic)
+    {
+        NoteInfo note = nearestNote(detected, active.a4, active.temperament);
+        reference = note.frequency;
+        midi = note.midi;
+        cents = note.cents;
+    }
+    else
+    {
+        if (active.mode == DetectionMode::Strings)
+        {
+            reference = active.strings[result.stringIndex];
+            midi = TUNINGS[active.tuning].midi[result.stringIndex];
+        }
+        cents = 1200.0f * fastLog2(detected / reference);
+    }
+
+    const char *color = "\033[32m", *verdict = "In tune  ";
+    if (std::abs(cents) > IN_TUNE_CENTS)
+    {
+        color = cents > 0.0f ? "\033[31m" : "\033[34m";
+        verdict = cents > 0.0f ? "Too sharp" : "Too flat ";
+    }
+
+    char bar[METER_WIDTH + 1];
+    if (active.mode == DetectionMode::Target && active.strobe)
+    {
+        // Stripes drift right when sharp and left when flat, standing still in tune
+        int offset = static_cast<int>(reading.phase * 8);
+        for (int i = 0; i < STROBE_WIDTH; ++i)
+            bar[i] = ((i - offset + 8) % 8) < 4 ? '#' : '.';
+        bar[STROBE_WIDTH] = '\0';
+    }
+    else
+    {
+        int needle = static_cast<int>(std::lround((std::max(-50.0f, std::min(50.0f, cents)) + 50.0f) * (METER_WIDTH - 1) / 100.0f));
+        for (int i = 0; i < METER_WIDTH; ++i)
+            bar[i] = i == METER_WIDTH / 2 ? '|' : '-';
+        bar[needle] = '#';
+        bar[METER_WIDTH] = '\0';
+    }
+
+    if (midi >= 0)
+    {
+        char name[8];
+        std::snprintf(name, sizeof(name), "%s%d", noteName(midi), noteOctave(midi));
+        appendFormat(out, capacity, length, "%-4s ", name);
+    }
+    appendFormat(out, capacity, length, "%+6.1f cents [%s%s\033[0m] %7.2f Hz | %s%s\033[0m", cents, color, bar,
+                 detected, color, verdict);
+    return length;
+}
+
+void GuitarTuner::printStats() const
+{
+    PipelineStats stats = pipeline->getStats();
+    std::cout << "Blocks: " << stats.blocks << " (" << stats.droppedBlocks << " dropped) | "
+              << "Readings: " << stats.readings << " (" << stats.skippedReadings << " between frames) | "
+              << "Stream warnings: " << streamWarnings.load() << "\n";
+    std::cout << "Latency avg/max (us): queue " << stats.queue.avgMicros << "/" << stats.queue.maxMicros
+              << ", analysis " << stats.analysis.avgMicros << "/" << stats.analysis.maxMicros
+              << ", render " << stats.render.avgMicros << "/" << stats.render.maxMicros
+              << ", retarget (" << stats.retarget.count << ") " << stats.retarget.avgMicros << "/" << stats.retarget.maxMicros << "\n";
+#ifndef NDEBUG
+    // Read after the stats: an analysis guard counts its block before its violation
+    std::cout << "Allocating blocks: " << AllocationCounter::violations() - stats.allocatingBlocks << " in the callback, "
+              << stats.allocatingBlocks << " in analysis\n";
+#endif
+    std::cout << "Analysis time: " << stats.analysisSeconds * 1000.0 << " ms wall, " << stats.analysisCpuSeconds * 1000.0
+              << " ms CPU | Rate now: ";
+    if (stats.analysisInterval > 0)
+        std::cout << static_cast<float>(SAMPLE_RATE) / stats.analysisInterval << " analyses/s\n\n";
+    else
+        std::cout << "stopped (silence)\n\n";
 }
 
 // Prompt user to choose which string to tune
 bool GuitarTuner::selectString()
 {
-    std::map<std::string, float> strings = {
-        {"E2", 82.41f}, {"A2", 110.00f}, {"D3", 146.83f}, {"G3", 196.00f}, {"B3", 246.94f}, {"E4", 329.63f}};
-
     std::string input;
     while (true)
     {
-        std::cout << "\nSelect string to tune (\033[33mE2\033[0m, \033[33mA2\033[0m, \033[33mD3\033[0m, \033[33mG3\033[0m, \033[33mB3\033[0m, \033[33mE4\033[0m), or '\033[33mQ\033[0m' to quit: ";
+        const Tuning &tuning = TUNINGS[settings.tuning];
+        std::cout << "\nSelect string to tune (";
+        for (int s = 0; s < tuning.stringCount; ++s)
+            std::cout << (s ? ", " : "") << "\033[33m" << noteName(tuning.midi[s]) << noteOctave(tuning.midi[s]) << "\033[0m";
+        std::cout << ") or any note, '\033[33mA\033[0m' for auto, '\033[33mC\033[0m' for chromatic, "
+                  << "'\033[33mT\033[0m' to select tuning (now: " << tuning.name << "), "
+                  << "'\033[33mE\033[0m' to switch temperament (now: " << temperamentName(settings.temperament) << "), "
+                  << "'\033[33mR\033[0m' to set reference A4 (now: " << settings.a4 << " Hz), ";
+        if (channels.size() > 1)
+        {
+            std::cout << "'\033[33mI\033[0m' to select input (now: ";
+            if (selectedChannel < 0)
+                std::cout << "all";
+            else
+                std::cout << inputNumber(selectedChannel);
+            std::cout << "), ";
+        }
+        std::cout << "'\033[33mM\033[0m' to switch correlation method (now: " << methodName() << "), "
+                  << "'\033[33mN\033[0m' to switch target search (now: " << targetSearchName() << "), "
+                  << "'\033[33mS\033[0m' to toggle strobe (now: " << (settings.strobe ? "on" : "off") << "), "
+                  << "'\033[33mP\033[0m' to switch pitch engine (now: " << FrequencyDetector::engineName(settings.engine) << "), or '\033[33mQ\033[0m' to quit: ";
         std::getline(std::cin, input);
 
         // Convert input to uppercase for case-insensitive comparison
@@ -98,13 +577,92 @@ bool GuitarTuner::selectString()
         if (input == "Q")
             return false;
 
-        auto it = strings.find(input);
-        if (it != strings.end())
+        if (input == "M")
+        {
+            settings.method = settings.method == CorrelationMethod::Direct ? CorrelationMethod::FFT : CorrelationMethod::Direct;
+            postSettings();
+            std::cout << "Correlation method: " << methodName() << "\n";
+            continue;
+        }
+
+        if (input == "N")
+        {
+            settings.targetSearch = settings.targetSearch == TargetSearch::Lags ? TargetSearch::FilterBank : TargetSearch::Lags;
+            postSettings();
+            std::cout << "Target search: " << targetSearchName() << "\n";
+            continue;
+        }
+
+        if (input == "S")
+        {
+            settings.strobe = !settings.strobe;
+            postSettings();
+            std::cout << "Strobe: " << (settings.strobe ? "on" : "off") << "\n";
+            continue;
+        }
+
+        if (input == "P")
+        {
+            nextEngine();
+            std::cout << "Pitch engine: " << FrequencyDetector::engineName(settings.engine) << "\n";
+            continue;
+        }
+
+        if (input == "I" && channels.size() > 1)
         {
-            currentString = input;
-            targetFreq = it->second;
-            detector.setTarget(targetFreq);
-            return true;
+            selectInput();
+            continue;
+        }
+
+        if (input == "R")
+        {
+            selectReference();
+            continue;
+        }
+
+        if (input == "T")
+        {
+            selectTuning();
+            continue;
+        }
+
+        if (input == "E")
+        {
+            nextTemperament();
+            std::cout << "Temperament: " << temperamentName(settings.temperament) << "\n";
+            continue;
+        }
+
+        if (input == "C")
+        {
+            settings.mode = DetectionMode::Chromatic;
+            settings.targetNote = -1;
+            settings.targetFreq = 0.0f;
+            if (postSettings())
+                return true;
+            continue;
+        }
+
+        if (input == "A")
+        {
+            settings.mode = DetectionMode::Strings;
+            settings.targetNote = -1;
+            settings.targetFreq = 0.0f;
+            if (postSettings())
+                return true;
+            continue;
+        }
+
+        // Strings are named by their note, so any note name selects a target
+        int midi = parseNote(input.c_str());
+        if (midi >= 0)
+        {
+            settings.mode = DetectionMode::Target;
+            settings.targetNote = midi;
+            settings.targetFreq = noteFrequency(midi, settings.a4, settings.temperament);
+            if (postSettings())
+                return true;
+            continue;
         }
         else
         {
@@ -112,3 +670,113 @@ bool GuitarTuner::selectString()
         }
     }
 }
+
+void GuitarTuner::selectReference()
+{
+    std::string input;
+    std::cout << "Reference A4 in Hz (" << MIN_REFERENCE_A4 << "-" << MAX_REFERENCE_A4 << "): ";
+    std::getline(std::cin, input);
+
+    float a4 = 0.0f;
+    try
+    {
+        a4 = std::stof(input);
+    }
+    catch (const std::exception &)
+    {
+    }
+    if (a4 < MIN_REFERENCE_A4 || a4 > MAX_REFERENCE_A4)
+    {
+        std::cout << "\033[1;31mInvalid reference!\033[0m\n";
+        return;
+    }
+
+    settings.a4 = a4;
+    retune();
+    postSettings();
+    std::cout << "Reference A4: " << settings.a4 << " Hz\n";
+}
+
+void GuitarTuner::selectTuning()
+{
+    for (int t = 0; t < TUNING_COUNT; ++t)
+    {
+        std::cout << "  " << t + 1 << ") " << TUNINGS[t].name << ":";
+        for (int s = 0; s < TUNINGS[t].stringCount; ++s)
+            std::cout << " " << noteName(TUNINGS[t].midi[s]) << noteOctave(TUNINGS[t].midi[s]);
+        std::cout << "\n";
+    }
+    std::cout << "Tuning (1-" << TUNING_COUNT << "): ";
+
+    std::string input;
+    std::getline(std::cin, input);
+
+    int number = 0;
+    try
+    {
+        number = std::stoi(input);
+    }
+    catch (const std::exception &)
+    {
+    }
+    if (number < 1 || number > TUNING_COUNT)
+    {
+        std::cout << "\033[1;31mInvalid tuning!\033[0m\n";
+        return;
+    }
+
+    settings.tuning = number - 1;
+    retune();
+    postSettings();
+    std::cout << "Tuning: " << TUNINGS[settings.tuning].name << "\n";
+}
+
+void GuitarTuner::nextTemperament()
+{
+    settings.temperament = static_cast<Temperament>((static_cast<int>(settings.temperament) + 1) % TEMPERAMENT_COUNT);
+    retune();
+    postSettings();
+}
+
+// The target moves with the reference and temperament, whichever string it belongs to
+void GuitarTuner::retune()
+{
+    if (settings.targetNote >= 0)
+        settings.targetFreq = noteFrequency(settings.targetNote, settings.a4, settings.temperament);
+
+    settings.stringCount = TUNINGS[settings.tuning].stringCount;
+    for (int s = 0; s < settings.stringCount; ++s)
+        settings.strings[s] = stringFrequency(s);
+}
+
+float GuitarTuner::stringFrequency(int index) const
+{
+    return noteFrequency(TUNINGS[settings.tuning].midi[index], settings.a4, settings.temperament);
+}
+
+const char *GuitarTuner::methodName() const
+{
+    return settings.method == CorrelationMethod::FFT ? "FFT" : "Direct";
+}
+
+const char *GuitarTuner::targetSearchName() const
+{
+    return settings.targetSearch == TargetSearch::FilterBank ? "filter bank" : "lags";
+}
+
+void GuitarTuner::nextEngine()
+{
+    switch (settings.engine)
+    {
+    case PitchEngine::Autocorrelation:
+        settings.engine = PitchEngine::YIN;
+        break;
+    case PitchEngine::YIN:
+        settings.engine = PitchEngine::McLeod;
+        break;
+    default:
+        settings.engine = PitchEngine::Autocorrelation;
+        break;
+    }
+    postSettings();
+}
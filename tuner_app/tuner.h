@@ -1,26 +1,85 @@
 #include "RtAudio.h"
 #include "frequency_detector.h"
+#include "pitch_ring.h"
+#include "streaming_analyzer.h"
+#include "tuner_pipeline.h"
+#include <atomic>
 #include <iostream>
 #include <cmath>
 #include <thread>
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <string>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <iomanip>
+#include <cstdio>
+#include <cstdarg>
+#include <csignal>
+#include <stdexcept>
 #pragma once
 
 // Class that manages user interaction and audio processing for tuning
 class GuitarTuner
 {
 public:
-    GuitarTuner();
+    // Tune channelCount inputs of the default device at once, starting at input firstChannel (0-based)
+    explicit GuitarTuner(int channelCount = 1, int firstChannel = 1);
     void run();
 
+    // No prompts and no meter: publish every reading of every input, in chromatic mode, to the named
+    // shared-memory ring (see PitchRingReader) until interrupted
+    void runHeadless(const std::string &ringName);
+
 private:
+    static constexpr int ENGINE_COUNT = 3;
+
+    // Detection state of one input; while the stream runs only its analysis worker touches it
+    struct Channel
+    {
+        Channel();
+
+        // One preallocated detector per engine
+        std::unique_ptr<FrequencyDetector> engines[ENGINE_COUNT];
+        FrequencyDetector *detector = nullptr;
+        StrobeTracker strobe;
+        bool strobing = false; // strobe attached to the analyzer
+        OnsetDetector onsets;
+        StreamingAnalyzer analyzer;
+    };
+
     RtAudio::StreamParameters inputParams;
-    FrequencyDetector detector;
-    std::string currentString;
-    float targetFreq;
-    int frameCount;
+    int firstChannel;
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::unique_ptr<TunerPipeline> pipeline;
+    std::atomic<unsigned int> streamWarnings{0};
+    std::atomic<bool> streamFailed{false}; // set by RtAudio's error callback, cleared by startStream()
+    std::atomic<bool> displaying{false};
+    std::mutex frameMutex; // held by drawFrame(); taken by the UI to know no frame is still being drawn
+
+    // UI thread state; the pipeline gets copies of settings through postSettings()
+    TunerSettings settings;                  // being edited, for the selected input or all of them
+    std::vector<TunerSettings> channelSettings;
+    int selectedChannel = -1;                // -1: all inputs
+
+    // Render thread state
+    std::vector<char> frameText; // one frame of meter lines, preallocated
+    int drawnLines = 0;          // lines of the previous frame, 0 when the meter starts afresh
+
+    // Open the default input device and start the pipeline and the stream; throws std::runtime_error
+    // with RtAudio's message if the device cannot be opened or started
+    void startStream(RtAudio &audio);
+    // Stop and close whatever is open or running; safe to call after a failure
+    void stopStream(RtAudio &audio);
+    // startStream() plus the time to the first reading, reported on the console
+    void openSession(RtAudio &audio);
+    // RtAudio error callback: warnings are counted, anything else marks the stream as failed
+    void streamError(RtAudioErrorType type);
+
+    // Runs on an analysis worker in headless mode
+    void publishReading(PitchRingWriter &ring, const TunerReading &reading);
 
     // RtAudio callback wrapper (static)
     static int audioCallbackWrapper(void *outputBuffer, void *inputBuffer, unsigned int nFrames,
@@ -29,6 +88,52 @@ private:
     // Actual audio callback that processes the input audio
     int audioCallback(float *input, unsigned int nFrames, RtAudioStreamStatus status);
 
+    // Runs on the channel's analysis worker: switch engine and retarget the detector
+    void applySettings(int channel, const TunerSettings &s);
+
+    // Stamp the UI's settings and hand them to the selected inputs' analysis workers. Returns false
+    // if an input's queue stayed full; that input keeps, and channelSettings records, its old settings.
+    bool postSettings();
+
+    // Ask which input the following settings apply to
+    void selectInput();
+
+    // Input number as labelled on the interface, 1-based
+    int inputNumber(int channel) const;
+
+    // Redraw the meter lines with the newest reading of every input
+    void drawFrame(const std::vector<TunerReading> &frame);
+
+    // Format one input's meter line into out; returns its length
+    int formatMeter(char *out, int capacity, const TunerReading &reading, PipelineClock::time_point now) const;
+
+    // Print pipeline counters after a tuning session
+    void printStats() const;
+
     // Function to select the string to tune
     bool selectString();
+
+    // Ask for a new A4 reference and rescale the target and string frequencies
+    void selectReference();
+
+    // Ask for one of the named tunings
+    void selectTuning();
+
+    // Select the next temperament
+    void nextTemperament();
+
+    // Recompute the target and string frequencies from the tuning, reference and temperament
+    void retune();
+
+    // Frequency of a string of the tuning at the current reference and temperament
+    float stringFrequency(int index) const;
+
+    // Human-readable name of the selected correlation method
+    const char *methodName() const;
+
+    // Human-readable name of the selected target-mode search
+    const char *targetSearchName() const;
+
+    // Select the next pitch engine, keeping the mode and settings
+    void nextEngine();
 };
@@ -0,0 +1,355 @@
+#include "tuner_pipeline.h"
+#include "alloc_counter.h"
+#include <algorithm>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// How long an idle worker sleeps before polling its queues again
+#define IDLE_SLEEP std::chrono::microseconds(500)
+// Frames drawn per second, independent of the analysis rate
+#define FRAME_RATE 30
+
+// CPU time consumed by the calling thread so far. Windows only updates it at scheduler ticks, so
+// single blocks mostly read 0 or a whole tick there; summed over a session it evens out.
+static std::uint64_t threadCpuNanos()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 100;
+#else
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + now.tv_nsec;
+#endif
+}
+
+TunerPipeline::Channel::Channel(StreamingAnalyzer *analyzer)
+    : analyzer(analyzer), blocks(BLOCK_QUEUE_SIZE), settingsQueue(SETTINGS_QUEUE_SIZE) {}
+
+TunerPipeline::TunerPipeline(const std::vector<StreamingAnalyzer *> &analyzers, ApplyFunction apply, RenderFunction render,
+                             int workers)
+    : apply(std::move(apply)), render(std::move(render))
+{
+    for (StreamingAnalyzer *analyzer : analyzers)
+        channels.push_back(std::unique_ptr<Channel>(new Channel(analyzer)));
+
+    if (workers <= 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    workerCount = std::max(1, std::min(workers, static_cast<int>(channels.size())));
+}
+
+TunerPipeline::~TunerPipeline()
+{
+    stop();
+}
+
+void TunerPipeline::start()
+{
+    if (running)
+        return;
+
+    for (int c = 0; c < getChannelCount(); ++c)
+    {
+        // Discard anything left over from a previous run
+        Channel &channel = *channels[c];
+        AudioBlock *block;
+        while ((block = channel.blocks.readSlot()) != nullptr)
+            channel.blocks.release();
+        channel.renderedVersion = channel.latest.version();
+
+        channel.blockCount = 0;
+        channel.droppedBlocks = 0;
+        channel.readingCount = 0;
+        channel.skippedReadings = 0;
+        channel.analysisInterval = 0;
+        channel.queueLatency.reset();
+        channel.analysisLatency.reset();
+        channel.cpuNanos = 0;
+        channel.allocatingBlocks = 0;
+        channel.renderLatency.reset();
+        channel.retargetLatency.reset();
+
+        // Settings posted while stopped take effect immediately and do not count as a retarget
+        applyPendingSettings(c);
+        channel.renderedSequence = channel.activeSettings.sequence;
+    }
+
+    running = true;
+    for (int w = 0; w < workerCount; ++w)
+        workers.emplace_back(&TunerPipeline::workerLoop, this, w);
+    renderThread = std::thread(&TunerPipeline::renderLoop, this);
+}
+
+void TunerPipeline::stop()
+{
+    running = false;
+    for (std::thread &worker : workers)
+        if (worker.joinable())
+            worker.join();
+    workers.clear();
+    if (renderThread.joinable())
+        renderThread.join();
+}
+
+bool TunerPipeline::isRunning() const
+{
+    return running;
+}
+
+void TunerPipeline::setPublisher(PublishFunction publish)
+{
+    this->publish = std::move(publish);
+}
+
+int TunerPipeline::getChannelCount() const
+{
+    return static_cast<int>(channels.size());
+}
+
+int TunerPipeline::getWorkerCount() const
+{
+    return workerCount;
+}
+
+void TunerPipeline::pushBlock(const float *input, int frames)
+{
+    PipelineClock::time_point now = PipelineClock::now();
+    int channelCount = getChannelCount();
+    while (frames > 0)
+    {
+        int count = std::min(frames, static_cast<int>(BLOCK_CAPACITY));
+        for (int c = 0; c < channelCount; ++c)
+        {
+            Channel &channel = *channels[c];
+            channel.blockCount.fetch_add(1, std::memory_order_relaxed);
+
+            AudioBlock *block = channel.blocks.writeSlot();
+            if (!block)
+            {
+                channel.droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Deinterleave straight into the queue slot
+            const float *source = input + c;
+            for (int i = 0; i < count; ++i)
+                block->samples[i] = source[i * channelCount];
+            block->size = count;
+            block->captured = now;
+            channel.blocks.publish();
+        }
+
+        input += count * channelCount;
+        frames -= count;
+    }
+}
+
+bool TunerPipeline::postSettings(int channel, const TunerSettings &settings)
+{
+    return channels[channel]->settingsQueue.tryPush(settings);
+}
+
+void TunerPipeline::applyPendingSettings(int c)
+{
+    // Only the newest request matters; older ones were superseded before they could take effect
+    Channel &channel = *channels[c];
+    bool changed = false;
+    while (channel.settingsQueue.tryPop(channel.activeSettings))
+        changed = true;
+    if (changed && apply)
+        apply(c, channel.activeSettings);
+}
+
+void TunerPipeline::workerLoop(int worker)
+{
+    // Channels are dealt out round-robin, so every queue keeps exactly one consumer
+    while (running)
+    {
+        bool busy = false;
+        for (int c = worker; c < getChannelCount(); c += workerCount)
+        {
+            applyPendingSettings(c);
+            busy |= analyzeBlock(c);
+        }
+        if (!busy)
+            std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+}
+
+bool TunerPipeline::analyzeBlock(int c)
+{
+    Channel &channel = *channels[c];
+    AudioBlock *block = channel.blocks.readSlot();
+    if (!block)
+        return false;
+
+    PipelineClock::time_point start = PipelineClock::now();
+    std::uint64_t cpuStart = threadCpuNanos();
+    channel.queueLatency.add(start - block->captured);
+
+    // The detectors run here, not in the callback: debug builds count blocks whose analysis allocates
+    int analyses;
+    {
+        AllocationGuard allocationGuard;
+        analyses = channel.analyzer->push(block->samples, block->size);
+        if (allocationGuard.allocations() > 0)
+            channel.allocatingBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+    PipelineClock::time_point captured = block->captured;
+    channel.blocks.release();
+
+    PipelineClock::time_point end = PipelineClock::now();
+    channel.analysisLatency.add(end - start);
+    channel.cpuNanos.fetch_add(threadCpuNanos() - cpuStart, std::memory_order_relaxed);
+    channel.analysisInterval.store(channel.analyzer->getInterval(), std::memory_order_relaxed);
+
+    if (analyses == 0)
+        return true;
+
+    const StreamReading &latest = channel.analyzer->latest();
+    TunerReading reading;
+    reading.channel = c;
+    reading.pitch = latest.pitch;
+    reading.rms = latest.rms;
+    reading.endSample = latest.endSample;
+    reading.phase = latest.phase;
+    reading.onset = latest.onset;
+    reading.analysisMicros = std::chrono::duration<double, std::micro>(end - start).count();
+    reading.captured = captured;
+    reading.posted = end;
+    reading.settings = channel.activeSettings;
+    channel.latest.store(reading);
+    if (publish)
+        publish(reading);
+    channel.readingCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void TunerPipeline::renderLoop()
+{
+    std::vector<TunerReading> frame(channels.size());
+    for (int c = 0; c < getChannelCount(); ++c)
+        frame[c].channel = c;
+    const PipelineClock::duration period = std::chrono::duration_cast<PipelineClock::duration>(std::chrono::seconds(1)) / FRAME_RATE;
+    PipelineClock::time_point next = PipelineClock::now();
+    while (running)
+    {
+        // Frames that were missed are skipped rather than drawn back to back
+        next = std::max(next + period, PipelineClock::now());
+        std::this_thread::sleep_until(next);
+        renderFrame(frame);
+    }
+
+    // One more frame after stop() so the final readings are shown
+    renderFrame(frame);
+}
+
+void TunerPipeline::renderFrame(std::vector<TunerReading> &frame)
+{
+    PipelineClock::time_point now = PipelineClock::now();
+    for (int c = 0; c < getChannelCount(); ++c)
+    {
+        Channel &channel = *channels[c];
+        if (channel.latest.version() == channel.renderedVersion)
+            continue;
+
+        std::uint64_t version = channel.latest.load(frame[c]);
+        channel.skippedReadings.fetch_add(version - channel.renderedVersion - 1, std::memory_order_relaxed);
+        channel.renderedVersion = version;
+        channel.renderLatency.add(now - frame[c].posted);
+        if (frame[c].settings.sequence != channel.renderedSequence)
+        {
+            channel.renderedSequence = frame[c].settings.sequence;
+            channel.retargetLatency.add(now - frame[c].settings.issued);
+        }
+    }
+    if (render)
+        render(frame);
+}
+
+PipelineStats TunerPipeline::getStats(int c) const
+{
+    const Channel &channel = *channels[c];
+    PipelineStats stats;
+    stats.blocks = channel.blockCount.load(std::memory_order_relaxed);
+    stats.droppedBlocks = channel.droppedBlocks.load(std::memory_order_relaxed);
+    stats.readings = channel.readingCount.load(std::memory_order_relaxed);
+    stats.skippedReadings = channel.skippedReadings.load(std::memory_order_relaxed);
+    stats.queue = channel.queueLatency.snapshot();
+    stats.analysis = channel.analysisLatency.snapshot();
+    stats.render = channel.renderLatency.snapshot();
+    stats.retarget = channel.retargetLatency.snapshot();
+    stats.analysisSeconds = channel.analysisLatency.totalNanos.load(std::memory_order_relaxed) * 1e-9;
+    stats.analysisCpuSeconds = channel.cpuNanos.load(std::memory_order_relaxed) * 1e-9;
+    stats.allocatingBlocks = channel.allocatingBlocks.load(std::memory_order_relaxed);
+    stats.analysisInterval = channel.analysisInterval.load(std::memory_order_relaxed);
+    return stats;
+}
+
+PipelineStats TunerPipeline::getStats() const
+{
+    PipelineStats total;
+    for (int c = 0; c < getChannelCount(); ++c)
+    {
+        PipelineStats stats = getStats(c);
+        total.blocks += stats.blocks;
+        total.droppedBlocks += stats.droppedBlocks;
+        total.readings += stats.readings;
+        total.skippedReadings += stats.skippedReadings;
+        merge(total.queue, stats.queue);
+        merge(total.analysis, stats.analysis);
+        merge(total.render, stats.render);
+        merge(total.retarget, stats.retarget);
+        total.analysisSeconds += stats.analysisSeconds;
+        total.analysisCpuSeconds += stats.analysisCpuSeconds;
+        total.allocatingBlocks += stats.allocatingBlocks;
+        if (stats.analysisInterval > 0 && (total.analysisInterval == 0 || stats.analysisInterval < total.analysisInterval))
+            total.analysisInterval = stats.analysisInterval;
+    }
+    return total;
+}
+
+void TunerPipeline::merge(StageLatency &total, const StageLatency &part)
+{
+    std::uint64_t count = total.count + part.count;
+    if (count > 0)
+        total.avgMicros = (total.avgMicros * total.count + part.avgMicros * part.count) / count;
+    total.count = count;
+    total.maxMicros = std::max(total.maxMicros, part.maxMicros);
+}
+
+void TunerPipeline::LatencyCounter::add(PipelineClock::duration elapsed)
+{
+    std::uint64_t nanos = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    if (nanos > maxNanos.load(std::memory_order_relaxed))
+        maxNanos.store(nanos, std::memory_order_relaxed);
+}
+
+void TunerPipeline::LatencyCounter::reset()
+{
+    count = 0;
+    totalNanos = 0;
+    maxNanos = 0;
+}
+
+StageLatency TunerPipeline::LatencyCounter::snapshot() const
+{
+    StageLatency latency;
+    latency.count = count.load(std::memory_order_relaxed);
+    if (latency.count > 0)
+        latency.avgMicros = totalNanos.load(std::memory_order_relaxed) / 1000.0 / latency.count;
+    latency.maxMicros = maxNanos.load(std::memory_order_relaxed) / 1000.0;
+    return latency;
+}
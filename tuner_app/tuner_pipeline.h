@@ -0,0 +1,197 @@
+#include "notes.h"
+#include "seqlock.h"
+#include "spsc_queue.h"
+#include "streaming_analyzer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#pragma once
+
+using PipelineClock = std::chrono::steady_clock;
+
+// Retargeting request from the UI. Posted through a wait-free queue and applied by the channel's
+// analysis worker between blocks, so the string, tuning, reference or engine can change without a stream restart.
+struct TunerSettings
+{
+    unsigned int sequence = 0;
+    PitchEngine engine = PitchEngine::McLeod; // fewest octave errors in bench/detector_bench; autocorrelation is opt-in
+    CorrelationMethod method = CorrelationMethod::Direct;
+    DetectionMode mode = DetectionMode::Target;
+    TargetSearch targetSearch = TargetSearch::Lags;
+    bool strobe = false;        // target mode: strobe tracker instead of the detector
+    float targetFreq = 0.0f;    // target mode
+    int targetNote = -1;        // target mode: MIDI note of the target
+    float a4 = 440.0f;          // reference pitch the target and string frequencies were derived from
+    Temperament temperament = Temperament::Equal;
+    int tuning = 0;             // index into TUNINGS the strings were taken from
+    int stringCount = 0;        // auto string mode
+    float strings[MAX_STRINGS] = {};
+    PipelineClock::time_point issued;
+};
+
+// A reading on its way from an analysis worker to the render thread
+struct TunerReading
+{
+    int channel = 0;
+    PitchResult pitch;
+    float rms = 0.0f;
+    long long endSample = 0;
+    float phase = 0.0f; // strobe mode: heterodyne phase in turns
+    bool onset = false; // first reading of a new note
+    double analysisMicros = 0.0;
+    PipelineClock::time_point captured; // when the newest block of the window reached the callback
+    PipelineClock::time_point posted;   // when the analysis worker queued the reading
+    TunerSettings settings;             // settings the window was analyzed with
+};
+
+// Average and worst-case latency of one pipeline stage
+struct StageLatency
+{
+    std::uint64_t count = 0;
+    double avgMicros = 0.0;
+    double maxMicros = 0.0;
+};
+
+struct PipelineStats
+{
+    std::uint64_t blocks = 0;
+    std::uint64_t droppedBlocks = 0;    // sample queue full: the analysis worker fell behind
+    std::uint64_t readings = 0;
+    std::uint64_t skippedReadings = 0;  // replaced by a newer one before a frame showed them
+    StageLatency queue;                 // audio callback -> analysis start
+    StageLatency analysis;              // analysis of one block
+    StageLatency render;                // reading posted -> drawn in a frame
+    StageLatency retarget;              // settings posted -> first reading rendered with them
+    double analysisSeconds = 0.0;       // wall-clock time the workers spent analyzing, in total
+    double analysisCpuSeconds = 0.0;    // CPU time of the worker threads while analyzing, in total
+    std::uint64_t allocatingBlocks = 0; // blocks whose analysis allocated memory (debug builds only)
+    int analysisInterval = 0;           // samples between analyses now, 0 while gated by silence;
+                                        // over all channels, the fastest one
+};
+
+// Multi-channel tuner pipeline. The audio callback deinterleaves each buffer once into per-channel
+// wait-free SPSC queues. A fixed pool of analysis workers, sized to the cores, owns the channels
+// round-robin: each worker drains its channels through their StreamingAnalyzers and stores every
+// reading into the channel's seqlock snapshot. A render thread wakes at a fixed frame rate, however
+// fast the analysis runs, and hands the newest reading of every channel to the render function.
+// Settings posted by the UI are handed to the apply function on the channel's worker before its
+// next block is analyzed. Channels share nothing, so throughput scales with the number of workers.
+class TunerPipeline
+{
+public:
+    using ApplyFunction = std::function<void(int channel, const TunerSettings &)>;
+    // Once per frame, with the newest reading of every channel (channel order; default-constructed
+    // until a channel's first reading)
+    using RenderFunction = std::function<void(const std::vector<TunerReading> &)>;
+    // Every reading, on the channel's analysis worker as soon as it is made; must not block
+    using PublishFunction = std::function<void(const TunerReading &)>;
+
+    // One analyzer per channel; workers <= 0 picks one per hardware thread, at most one per channel
+    TunerPipeline(const std::vector<StreamingAnalyzer *> &analyzers, ApplyFunction apply, RenderFunction render,
+                  int workers = 0);
+    ~TunerPipeline();
+
+    TunerPipeline(const TunerPipeline &) = delete;
+    TunerPipeline &operator=(const TunerPipeline &) = delete;
+
+    // Start/stop the worker threads. The analyzers must not be touched elsewhere while running.
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Not while running
+    void setPublisher(PublishFunction publish);
+
+    int getChannelCount() const;
+    int getWorkerCount() const;
+
+    // Audio thread: wait-free, never allocates. Takes frames of getChannelCount() interleaved samples;
+    // a channel whose queue is full drops the block
+    void pushBlock(const float *input, int frames);
+
+    // UI thread (single producer): queue new settings for one channel; false if its worker has not
+    // caught up. Settings posted before start() are applied by start() itself.
+    bool postSettings(int channel, const TunerSettings &settings);
+
+    // Totals and latencies over all channels, or for one channel
+    PipelineStats getStats() const;
+    PipelineStats getStats(int channel) const;
+
+private:
+    static constexpr int BLOCK_CAPACITY = 512;  // frames per queued block; larger callbacks are split
+    static constexpr int BLOCK_QUEUE_SIZE = 64; // ~680 ms of audio at 48 kHz
+    static constexpr int SETTINGS_QUEUE_SIZE = 8;
+
+    struct AudioBlock
+    {
+        float samples[BLOCK_CAPACITY];
+        int size;
+        PipelineClock::time_point captured;
+    };
+
+    // Single-writer latency accumulator that other threads may read at any time
+    struct LatencyCounter
+    {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> totalNanos{0};
+        std::atomic<std::uint64_t> maxNanos{0};
+
+        void add(PipelineClock::duration elapsed);
+        void reset();
+        StageLatency snapshot() const;
+    };
+
+    // Everything one channel needs; only its worker, the audio thread and the render thread touch it
+    struct Channel
+    {
+        Channel(StreamingAnalyzer *analyzer);
+
+        StreamingAnalyzer *analyzer;
+        SpscQueue<AudioBlock> blocks;
+        Seqlock<TunerReading> latest;
+        SpscQueue<TunerSettings> settingsQueue;
+        TunerSettings activeSettings;      // worker only
+        unsigned int renderedSequence = 0; // render thread only
+        std::uint64_t renderedVersion = 0; // render thread only
+
+        std::atomic<std::uint64_t> blockCount{0};
+        std::atomic<std::uint64_t> droppedBlocks{0};
+        std::atomic<std::uint64_t> readingCount{0};
+        std::atomic<std::uint64_t> skippedReadings{0};
+        std::atomic<int> analysisInterval{0};
+        LatencyCounter queueLatency;
+        LatencyCounter analysisLatency;
+        std::atomic<std::uint64_t> cpuNanos{0}; // worker thread CPU time spent in analysis
+        std::atomic<std::uint64_t> allocatingBlocks{0};
+        LatencyCounter renderLatency;
+        LatencyCounter retargetLatency;
+    };
+
+    void workerLoop(int worker);
+    void renderLoop();
+
+    // Render thread: collect the channels' newest readings and draw one frame
+    void renderFrame(std::vector<TunerReading> &frame);
+
+    // Worker: apply the newest queued settings, if any
+    void applyPendingSettings(int channel);
+
+    // Worker: analyze one queued block of the channel; false if there was none
+    bool analyzeBlock(int channel);
+
+    static void merge(StageLatency &total, const StageLatency &part);
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    ApplyFunction apply;
+    RenderFunction render;
+    PublishFunction publish;
+    int workerCount;
+
+    std::atomic<bool> running{false};
+    std::vector<std::thread> workers;
+    std::thread renderThread;
+};
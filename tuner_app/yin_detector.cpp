@@ -0,0 +1,99 @@
+#include "yin_detector.h"
+#include <algorithm>
+
+// Absolute threshold on the normalized difference; 0.10-0.15 is the range suggested by the YIN paper
+#define YIN_THRESHOLD 0.15f
+
+YinDetector::YinDetector(float sampleRate, int maxFrameSize)
+    : FrequencyDetector(sampleRate)
+{
+    configure(maxFrameSize);
+}
+
+PitchEngine YinDetector::getEngine() const
+{
+    return PitchEngine::YIN;
+}
+
+bool YinDetector::usesRawCorrelation() const
+{
+    return true;
+}
+
+void YinDetector::allocate(int frameSize)
+{
+    cmnd.assign(frameSize, 1.0f);
+}
+
+PitchResult YinDetector::estimate(const float *input, int size)
+{
+    PitchResult result;
+    int minLag, maxLag;
+    if (!searchRange(size, minLag, maxLag))
+        return result;
+
+    if (!computeCmnd(input, size, maxLag))
+        return result;
+
+    // First dip below the threshold, followed down to its local minimum; otherwise the global minimum
+    int bestLag = -1;
+    for (int lag = minLag; lag <= maxLag; ++lag)
+    {
+        if (cmnd[lag] < YIN_THRESHOLD)
+        {
+            while (lag < maxLag && cmnd[lag + 1] < cmnd[lag])
+                ++lag;
+            bestLag = lag;
+            break;
+        }
+    }
+    if (bestLag < 0)
+    {
+        bestLag = minLag;
+        for (int lag = minLag + 1; lag <= maxLag; ++lag)
+            if (cmnd[lag] < cmnd[bestLag])
+                bestLag = lag;
+    }
+
+    float period = bestLag + parabolicOffset(cmnd[bestLag - 1], cmnd[bestLag], cmnd[bestLag + 1]);
+    result.frequency = sampleRate / period;
+    result.confidence = std::max(0.0f, std::min(1.0f, 1.0f - cmnd[bestLag]));
+    return result;
+}
+
+// One minus the normalized difference, so a perfect period scores 1
+bool YinDetector::periodicity(const float *input, int size, int minLag, int maxLag)
+{
+    if (!computeCmnd(input, size, maxLag))
+        return false;
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+        score[lag] = 1.0f - cmnd[lag];
+    return true;
+}
+
+bool YinDetector::computeCmnd(const float *input, int size, int maxLag)
+{
+    computeCorrelation(input, size, 1, maxLag + 1);
+    computeEnergyPrefix(input, size);
+    if (energyPrefix[size] <= 0.0)
+        return false;
+
+    // Cumulative mean normalized difference: d'(t) = d(t) * t / sum(d(1..t))
+    double runningSum = 0.0;
+    cmnd[0] = 1.0f;
+    for (int lag = 1; lag <= maxLag + 1; ++lag)
+    {
+        double diff = energyPrefix[size - lag] + (energyPrefix[size] - energyPrefix[lag]) - 2.0 * correlation[lag];
+        if (diff < 0.0)
+            diff = 0.0;
+        runningSum += diff;
+        cmnd[lag] = runningSum > 0.0 ? static_cast<float>(diff * lag / runningSum) : 1.0f;
+    }
+    return true;
+}
+
+// The normalisation compensates for the shrinking overlap, so lags up to two thirds of the frame are usable
+int YinDetector::longestLag(int size) const
+{
+    return size * 2 / 3;
+}
@@ -0,0 +1,25 @@
+#include "frequency_detector.h"
+#pragma once
+
+// YIN engine: cumulative mean normalized difference function with an absolute threshold.
+// The difference function is derived from the autocorrelation (direct or FFT) and running
+// energy sums, d(t) = E(0, N-t) + E(t, N) - 2 r(t), instead of a separate O(N*L) loop.
+class YinDetector : public FrequencyDetector
+{
+public:
+    YinDetector(float sampleRate, int maxFrameSize);
+    PitchEngine getEngine() const override;
+    bool usesRawCorrelation() const override;
+
+protected:
+    void allocate(int maxFrameSize) override;
+    PitchResult estimate(const float *input, int size) override;
+    bool periodicity(const float *input, int size, int minLag, int maxLag) override;
+    int longestLag(int size) const override;
+
+private:
+    // Fill cmnd[0..maxLag + 1]; returns false if the frame is silent
+    bool computeCmnd(const float *input, int size, int maxLag);
+
+    std::vector<float> cmnd;
+};